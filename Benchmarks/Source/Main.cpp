@@ -0,0 +1,618 @@
+/*
+  ==============================================================================
+
+    Offline benchmarks for SimpleEq's audio-thread code paths.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <numeric>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PluginEditor.h"
+
+//==============================================================================
+// Counts the process's heap allocations, so a benchmark can check that a code path allocates
+// nothing once it has warmed up. Every form of operator new is counted everywhere; malloc, calloc,
+// realloc and the aligned forms only with glibc and the Windows debug CRT (see
+// AllocationHooks::countsMallocFamily). Allocations are also reported to AudioThreadGuard, which
+// the plugin's own hook would otherwise do.
+static std::atomic<long long> heapAllocationCount{ 0 };
+
+#define SIMPLEEQ_ON_ALLOCATION() (++heapAllocationCount, AudioThreadGuard::noteAllocation())
+#define SIMPLEEQ_HOOK_MALLOC_FAMILY 1
+#include "../../Source/AllocationHooks.h"
+
+// Reaches into ResponseCurveComponent, which keeps its curve update private.
+struct ResponseCurveBenchmark {
+    static void markAllBandsDirty(ResponseCurveComponent& component) {
+        component.lowCutResponseDirty = true;
+        component.peakResponseDirty = true;
+        component.highCutResponseDirty = true;
+    }
+
+    static void updateResponseCurve(ResponseCurveComponent& component) {
+        component.updateResponseCurve();
+    }
+};
+
+namespace {
+
+// Where malloc isn't counted, only operator new calls are, and the results say so.
+const char* const allocationsKey = AllocationHooks::countsMallocFamily ? "heapAllocations" : "operatorNewCalls";
+
+//==============================================================================
+// Per-call timings and the allocations counted inside the timed calls (see allocationsKey).
+struct TimingStats {
+    explicit TimingStats(int expectedCalls) {
+        nanoseconds.reserve((size_t)expectedCalls);
+    }
+
+    template<typename Function>
+    void measure(Function&& function) {
+        auto allocationsBefore = heapAllocationCount.load();
+        auto start = juce::Time::getHighResolutionTicks();
+        function();
+        auto ticks = juce::Time::getHighResolutionTicks() - start;
+        allocations += heapAllocationCount.load() - allocationsBefore;
+        nanoseconds.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9);
+    }
+
+    double getMean() const {
+        return nanoseconds.empty() ? 0.0 : std::accumulate(nanoseconds.begin(), nanoseconds.end(), 0.0) / (double)nanoseconds.size();
+    }
+
+    // Adds mean, percentiles and allocations to `entry`; per-sample figures too when each call
+    // covered samplesPerCall samples.
+    void addTo(juce::DynamicObject& entry, int samplesPerCall = 0) const {
+        auto sorted = nanoseconds;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            return sorted.empty() ? 0.0 : sorted[juce::jmin(sorted.size() - 1, (size_t)(p * (double)(sorted.size() - 1) + 0.5))];
+        };
+
+        entry.setProperty("calls", (int)sorted.size());
+        entry.setProperty("meanNs", getMean());
+        entry.setProperty("p50Ns", percentile(0.5));
+        entry.setProperty("p90Ns", percentile(0.9));
+        entry.setProperty("p99Ns", percentile(0.99));
+        entry.setProperty("maxNs", sorted.empty() ? 0.0 : sorted.back());
+        if (samplesPerCall > 0) {
+            entry.setProperty("nsPerSample", getMean() / samplesPerCall);
+            entry.setProperty("p99NsPerSample", percentile(0.99) / samplesPerCall);
+        }
+        entry.setProperty(allocationsKey, (juce::int64)allocations);
+    }
+
+    std::vector<double> nanoseconds;
+    long long allocations = 0;
+};
+
+juce::DynamicObject::Ptr makeResult(const juce::String& benchmark) {
+    juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+    entry->setProperty("benchmark", benchmark);
+    return entry;
+}
+
+void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random) {
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+        }
+    }
+}
+
+
+// The per-sample analyzer tap that SingleChannelSampleFifo::update used to run, kept as a baseline.
+template<typename BlockType>
+struct PerSampleFifo {
+    void prepare(int bufferSize) {
+        bufferToFill.setSize(1, bufferSize, false, true, true);
+        fifo.prepare(1, bufferSize);
+        fifoIndex = 0;
+    }
+
+    void update(const BlockType& buffer) {
+        auto* channelPtr = buffer.getReadPointer(0);
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            if (fifoIndex == bufferToFill.getNumSamples()) {
+                fifo.push(bufferToFill);
+                fifoIndex = 0;
+            }
+            bufferToFill.setSample(0, fifoIndex, channelPtr[i]);
+            ++fifoIndex;
+        }
+    }
+
+    Fifo<BlockType> fifo;
+    BlockType bufferToFill;
+    int fifoIndex = 0;
+};
+
+struct ChunkedFifo {
+    void prepare(int bufferSize) { fifo.prepare(bufferSize); }
+    void update(const juce::AudioBuffer<float>& buffer) { fifo.update(buffer); }
+
+    // Channel::Right reads channel 0, which is what the benchmark fills.
+    SingleChannelSampleFifo<juce::AudioBuffer<float>> fifo{ Channel::Right };
+};
+
+// Average nanoseconds per processBlock-sized call of the analyzer tap. A reader drains the FIFO
+// every few calls, roughly like the editor's timer does.
+template<typename TapType>
+double timeAnalyzerTap(int blockSize, int numBlocks) {
+    TapType tap;
+    tap.prepare(blockSize);
+
+    juce::AudioBuffer<float> block(1, blockSize);
+    juce::Random random;
+    for (int i = 0; i < blockSize; ++i) {
+        block.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+    }
+
+    juce::AudioBuffer<float> drained(1, blockSize);
+    auto drain = [&]() {
+        if constexpr (std::is_same_v<TapType, ChunkedFifo>) {
+            while (tap.fifo.getNumCompleteBuffersAvailable() > 0) {
+                tap.fifo.getAudioBuffer(drained);
+            }
+        }
+        else {
+            while (tap.fifo.getNumAvailableForReading() > 0) {
+                tap.fifo.pull(drained);
+            }
+        }
+    };
+
+    constexpr int blocksPerDrain = 8;
+    juce::int64 ticks = 0;
+    for (int n = 0; n < numBlocks; ++n) {
+        auto start = juce::Time::getHighResolutionTicks();
+        tap.update(block);
+        ticks += juce::Time::getHighResolutionTicks() - start;
+
+        if (n % blocksPerDrain == 0) {
+            drain();
+        }
+    }
+
+    auto seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+    return seconds * 1.0e9 / numBlocks;
+}
+
+void benchmarkAnalyzerTap(juce::Array<juce::var>& results) {
+    std::cout << "Analyzer tap (ns per block, one channel)" << std::endl;
+    std::cout << "block\tper-sample\tchunked\tspeedup" << std::endl;
+
+    for (auto blockSize : { 32, 64, 128, 256, 512, 1024 }) {
+        constexpr int numBlocks = 20000;
+        auto perSample = timeAnalyzerTap<PerSampleFifo<juce::AudioBuffer<float>>>(blockSize, numBlocks);
+        auto chunked = timeAnalyzerTap<ChunkedFifo>(blockSize, numBlocks);
+
+        std::cout << blockSize << "\t" << perSample << "\t" << chunked << "\t" << perSample / chunked << std::endl;
+
+        auto entry = makeResult("analyzerTap");
+        entry->setProperty("blockSize", blockSize);
+        entry->setProperty("perSampleTapNs", perSample);
+        entry->setProperty("chunkedTapNs", chunked);
+        results.add(entry.get());
+    }
+}
+
+
+// Average microseconds to get both channels' spectra, with a real FFT per channel and with both
+// channels packed into one complex FFT.
+void benchmarkStereoSpectra(juce::Array<juce::var>& results) {
+    std::cout << "Stereo analyzer spectra (us per frame)" << std::endl;
+    std::cout << "order\tseparate\tpacked\tspeedup" << std::endl;
+
+    juce::Random random;
+    std::array<AnalyzerHistory, 2> history;
+    std::vector<float> noise(FFTEngines::maxFFTSize);
+    for (auto& channel : history) {
+        for (auto& sample : noise) {
+            sample = random.nextFloat() * 2.f - 1.f;
+        }
+        channel.prepare(FFTEngines::maxFFTSize);
+        channel.append(noise.data(), (int)noise.size());
+    }
+
+    std::array<FFTDataGenerator<std::vector<float>>, 2> generators;
+    std::array<std::vector<float>, 2> fftData;
+    for (auto& data : fftData) {
+        FFTDataGenerator<std::vector<float>>::prepareFFTData(data);
+    }
+    PackedStereoFFT packedFFT;
+
+    constexpr int numFrames = 500;
+    for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 }) {
+        for (auto& generator : generators) {
+            generator.changeOrder(order);
+        }
+        auto separateStart = juce::Time::getHighResolutionTicks();
+        for (int n = 0; n < numFrames; ++n) {
+            for (size_t ch = 0; ch < 2; ++ch) {
+                generators[ch].produceFFTDataForRendering(history[ch], -48.f);
+                generators[ch].getFFTData(fftData[ch]);
+            }
+        }
+        auto separateTicks = juce::Time::getHighResolutionTicks() - separateStart;
+
+        auto packedStart = juce::Time::getHighResolutionTicks();
+        for (int n = 0; n < numFrames; ++n) {
+            packedFFT.perform(order, history[0], history[1], false, fftData[0], fftData[1], -48.f);
+        }
+        auto packedTicks = juce::Time::getHighResolutionTicks() - packedStart;
+
+        auto separate = juce::Time::highResolutionTicksToSeconds(separateTicks) * 1.0e6 / numFrames;
+        auto packed = juce::Time::highResolutionTicksToSeconds(packedTicks) * 1.0e6 / numFrames;
+        std::cout << (1 << order) << "\t" << separate << "\t" << packed << "\t" << separate / packed << std::endl;
+
+        auto entry = makeResult("stereoSpectra");
+        entry->setProperty("fftSize", 1 << order);
+        entry->setProperty("separateUs", separate);
+        entry->setProperty("packedUs", packed);
+        results.add(entry.get());
+    }
+}
+
+//==============================================================================
+enum class Automation { none, peakSweep, smoothedPeakSweep };
+
+const char* getAutomationName(Automation automation) {
+    switch (automation) {
+        case Automation::peakSweep: return "peakSweep";
+        case Automation::smoothedPeakSweep: return "smoothedPeakSweep";
+        case Automation::none: break;
+    }
+    return "none";
+}
+
+// Times processBlock on a stereo processor, the way a host drives it. Parameter changes are made
+// between blocks, outside the timed calls, as a host's automation would be.
+TimingStats timeProcessBlock(double sampleRate, int blockSize, Slope slope, Automation automation, juce::DynamicObject& entry) {
+    SimpleEqAudioProcessor processor;
+    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+
+    auto setParameter = [&processor](const juce::String& id, float value) {
+        auto* parameter = processor.apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    // Every band stays active so the transparent-chain shortcut never kicks in.
+    setParameter("LowCut Freq", 80.f);
+    setParameter("HighCut Freq", 12000.f);
+    setParameter("Peak Gain", 6.f);
+    setParameter("LowCut Slope", (float)slope);
+    setParameter("HighCut Slope", (float)slope);
+    setParameter("Smoothing", automation == Automation::smoothedPeakSweep ? 2.f : 0.f);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::Random random;
+    juce::AudioBuffer<float> input(2, blockSize), buffer(2, blockSize);
+    fillWithNoise(input, random);
+    juce::MidiBuffer midi;
+
+    // Two seconds of audio, and enough blocks for stable percentiles at large block sizes.
+    constexpr int warmUpBlocks = 32;
+    auto numBlocks = juce::jmax(256, juce::roundToInt(2.0 * sampleRate / blockSize));
+    TimingStats stats(numBlocks);
+
+    for (int n = -warmUpBlocks; n < numBlocks; ++n) {
+        if (automation != Automation::none) {
+            // One sweep of the peak from 100 Hz to 10 kHz per second of audio.
+            auto phase = std::fmod((n + warmUpBlocks) * blockSize / sampleRate, 1.0);
+            setParameter("Peak Freq", (float)(100.0 * std::pow(100.0, phase)));
+        }
+        buffer.makeCopyOf(input, true);
+
+        if (n < 0) {
+            processor.processBlock(buffer, midi);
+        }
+        else {
+            if (n == 0) {
+                processor.resetProcessTiming();
+            }
+            stats.measure([&] { processor.processBlock(buffer, midi); });
+        }
+    }
+
+    // The processor's own instrumentation, as the diagnostics overlay shows it.
+    auto timing = processor.getProcessTimingSnapshot();
+    entry.setProperty("overruns", (int)timing.numOverruns);
+    entry.setProperty("maxBudgetFraction", timing.maxLoad);
+    entry.setProperty("lowCutRedesigns", processor.getRedesignCount(ChainPositions::LowCut));
+    entry.setProperty("peakRedesigns", processor.getRedesignCount(ChainPositions::Peak));
+    entry.setProperty("highCutRedesigns", processor.getRedesignCount(ChainPositions::HighCut));
+    entry.setProperty("lowCutCacheHits", processor.getCacheHitCount(ChainPositions::LowCut));
+    entry.setProperty("peakCacheHits", processor.getCacheHitCount(ChainPositions::Peak));
+    entry.setProperty("highCutCacheHits", processor.getCacheHitCount(ChainPositions::HighCut));
+
+    processor.releaseResources();
+    return stats;
+}
+
+// Returns the number of allocations counted inside processBlock across the whole sweep.
+long long benchmarkProcessBlock(juce::Array<juce::var>& results) {
+    std::cout << "processBlock (ns per sample, stereo)" << std::endl;
+    std::cout << "rate\tblock\tslope\tautomation\tmean\tp99\t" << allocationsKey << std::endl;
+
+    long long totalAllocations = 0;
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0 }) {
+        for (auto blockSize : { 32, 64, 128, 256, 512, 1024, 2048 }) {
+            for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 }) {
+                for (auto automation : { Automation::none, Automation::peakSweep, Automation::smoothedPeakSweep }) {
+                    auto entry = makeResult("processBlock");
+                    auto stats = timeProcessBlock(sampleRate, blockSize, slope, automation, *entry);
+                    totalAllocations += stats.allocations;
+
+                    entry->setProperty("sampleRate", sampleRate);
+                    entry->setProperty("blockSize", blockSize);
+                    entry->setProperty("slopeDbPerOctave", 12 * (slope + 1));
+                    entry->setProperty("automation", getAutomationName(automation));
+                    stats.addTo(*entry, blockSize);
+                    results.add(entry.get());
+
+                    std::cout << sampleRate << "\t" << blockSize << "\t" << 12 * (slope + 1) << "\t" << getAutomationName(automation) << "\t"
+                              << (double)entry->getProperty("nsPerSample") << "\t" << (double)entry->getProperty("p99NsPerSample") << "\t"
+                              << stats.allocations << std::endl;
+                }
+            }
+        }
+    }
+    return totalAllocations;
+}
+
+// Every FIFO slot has to go round once before all the storage in circulation is full size.
+constexpr int analyzerWarmUpFrames = 100;
+constexpr int analyzerFrames = 1000;
+
+void benchmarkFFTData(juce::Array<juce::var>& results) {
+    std::cout << "FFTDataGenerator::produceFFTDataForRendering (us per frame)" << std::endl;
+    std::cout << "order\tmean\tp99\t" << allocationsKey << std::endl;
+
+    juce::AudioBuffer<float> monoBuffer(1, FFTEngines::maxFFTSize);
+    juce::Random random;
+    fillWithNoise(monoBuffer, random);
+
+    std::vector<float> fftData;
+    FFTDataGenerator<std::vector<float>>::prepareFFTData(fftData);
+
+    for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 }) {
+        FFTDataGenerator<std::vector<float>> generator;
+        generator.changeOrder(order);
+        TimingStats stats(analyzerFrames);
+
+        for (int n = -analyzerWarmUpFrames; n < analyzerFrames; ++n) {
+            if (n < 0) {
+                generator.produceFFTDataForRendering(monoBuffer, -48.f);
+            }
+            else {
+                stats.measure([&] { generator.produceFFTDataForRendering(monoBuffer, -48.f); });
+            }
+            while (generator.getNumAvailableFFTDataBlocks() > 0) {
+                generator.getFFTData(fftData);
+            }
+        }
+
+        auto entry = makeResult("produceFFTDataForRendering");
+        entry->setProperty("fftSize", 1 << order);
+        stats.addTo(*entry);
+        results.add(entry.get());
+
+        std::cout << (1 << order) << "\t" << stats.getMean() * 1.0e-3 << "\t" << (double)entry->getProperty("p99Ns") * 1.0e-3
+                  << "\t" << stats.allocations << std::endl;
+    }
+}
+
+void benchmarkPathGeneration(juce::Array<juce::var>& results) {
+    std::cout << "AnalyzerPathGenerator::generatePath (us per path)" << std::endl;
+    std::cout << "order\twidth\tdecimation\tmean\tp99\t" << allocationsKey << std::endl;
+
+    juce::AudioBuffer<float> monoBuffer(1, FFTEngines::maxFFTSize);
+    juce::Random random;
+    fillWithNoise(monoBuffer, random);
+
+    std::vector<float> fftData;
+    FFTDataGenerator<std::vector<float>>::prepareFFTData(fftData);
+    juce::Path displayedPath;
+
+    for (auto order : { FFTOrder::order2048, FFTOrder::order8192 }) {
+        FFTDataGenerator<std::vector<float>> fftDataGenerator;
+        fftDataGenerator.changeOrder(order);
+        fftDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+        fftDataGenerator.getFFTData(fftData);
+
+        for (auto width : { 600, 1200, 2400 }) {
+            const juce::Rectangle<float> fftBounds(0.f, 0.f, (float)width, 300.f);
+            const FrequencyAxis axis(width, 48000.0, {});
+
+            for (auto decimation : { PathDecimation::binStride, PathDecimation::peakPerColumn }) {
+                AnalyzerPathGenerator<juce::Path> pathGenerator;
+                pathGenerator.setDecimation(decimation);
+                TimingStats stats(analyzerFrames);
+
+                for (int n = -analyzerWarmUpFrames; n < analyzerFrames; ++n) {
+                    if (n < 0) {
+                        pathGenerator.generatePath(fftData, fftBounds, order, axis, -48.f);
+                    }
+                    else {
+                        stats.measure([&] { pathGenerator.generatePath(fftData, fftBounds, order, axis, -48.f); });
+                    }
+                    while (pathGenerator.getNumPathsAvailable() > 0) {
+                        pathGenerator.getPath(displayedPath);
+                    }
+                }
+
+                auto decimationName = decimation == PathDecimation::binStride ? "binStride" : "peakPerColumn";
+                auto entry = makeResult("generatePath");
+                entry->setProperty("fftSize", 1 << order);
+                entry->setProperty("width", width);
+                entry->setProperty("decimation", decimationName);
+                stats.addTo(*entry);
+                results.add(entry.get());
+
+                std::cout << (1 << order) << "\t" << width << "\t" << decimationName << "\t" << stats.getMean() * 1.0e-3
+                          << "\t" << (double)entry->getProperty("p99Ns") * 1.0e-3 << "\t" << stats.allocations << std::endl;
+            }
+        }
+    }
+}
+
+// Times the curve update with every band's response recomputed (a sample rate change or a full
+// redesign) and with all bands cached (only the sum and the path are rebuilt).
+void benchmarkResponseCurve(juce::Array<juce::var>& results) {
+    std::cout << "ResponseCurveComponent::updateResponseCurve (us per update)" << std::endl;
+    std::cout << "width\tbands\tmean\tp99\t" << allocationsKey << std::endl;
+
+    SimpleEqAudioProcessor processor;
+    processor.setPlayConfigDetails(2, 2, 48000.0, 512);
+    processor.prepareToPlay(48000.0, 512);
+
+    constexpr int numUpdates = 500;
+    for (auto width : { 600, 1200, 2400 }) {
+        ResponseCurveComponent curve(processor);
+        curve.setSize(width, 300);
+
+        for (auto allBandsDirty : { true, false }) {
+            TimingStats stats(numUpdates);
+            for (int n = -analyzerWarmUpFrames; n < numUpdates; ++n) {
+                if (allBandsDirty) {
+                    ResponseCurveBenchmark::markAllBandsDirty(curve);
+                }
+                if (n < 0) {
+                    ResponseCurveBenchmark::updateResponseCurve(curve);
+                }
+                else {
+                    stats.measure([&] { ResponseCurveBenchmark::updateResponseCurve(curve); });
+                }
+            }
+
+            auto bands = allBandsDirty ? "allDirty" : "cached";
+            auto entry = makeResult("updateResponseCurve");
+            entry->setProperty("width", width);
+            entry->setProperty("bands", bands);
+            stats.addTo(*entry);
+            results.add(entry.get());
+
+            std::cout << width << "\t" << bands << "\t" << stats.getMean() * 1.0e-3 << "\t"
+                      << (double)entry->getProperty("p99Ns") * 1.0e-3 << "\t" << stats.allocations << std::endl;
+        }
+    }
+
+    processor.releaseResources();
+}
+
+// Drives the analyzer's FFT and path stages the way PathProducer does, and counts the heap
+// allocations made by frames after warm-up. Where malloc isn't counted that count misses
+// HeapBlock and vector storage; juce::Path keeps its own out of reach, but the FFT frames must at
+// least keep handing round the buffers warm-up left behind.
+// Returns false if any steady-state frame allocated or moved to new storage.
+bool checkAnalyzerFramesDoNotAllocate() {
+    FFTDataGenerator<std::vector<float>> fftDataGenerator;
+    AnalyzerPathGenerator<juce::Path> pathGenerator;
+
+    juce::AudioBuffer<float> monoBuffer(1, FFTEngines::maxFFTSize);
+    juce::Random random;
+    for (int i = 0; i < monoBuffer.getNumSamples(); ++i) {
+        monoBuffer.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+    }
+
+    std::vector<float> fftData;
+    FFTDataGenerator<std::vector<float>>::prepareFFTData(fftData);
+    juce::Path displayedPath;
+
+    const juce::Rectangle<float> fftBounds(0.f, 0.f, 600.f, 300.f);
+    const FrequencyAxis axis((int)fftBounds.getWidth(), 48000.0, {});
+
+    auto runFrame = [&]() {
+        fftDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+        while (fftDataGenerator.getNumAvailableFFTDataBlocks() > 0) {
+            fftDataGenerator.getFFTData(fftData);
+        }
+
+        pathGenerator.generatePath(fftData, fftBounds, fftDataGenerator.getOrder(), axis, -48.f);
+        while (pathGenerator.getNumPathsAvailable() > 0) {
+            pathGenerator.getPath(displayedPath);
+        }
+    };
+
+    // The FIFO swaps blocks in and out, so the storage cycles between its slots and fftData.
+    std::vector<std::pair<const float*, size_t>> warmStorage;
+    auto currentStorage = [&fftData]() { return std::make_pair((const float*)fftData.data(), fftData.capacity()); };
+
+    for (int i = 0; i < analyzerWarmUpFrames; ++i) {
+        runFrame();
+        if (std::find(warmStorage.begin(), warmStorage.end(), currentStorage()) == warmStorage.end()) {
+            warmStorage.push_back(currentStorage());
+        }
+    }
+
+    constexpr int numFrames = analyzerFrames;
+    int framesOnNewStorage = 0;
+    auto before = heapAllocationCount.load();
+    for (int i = 0; i < numFrames; ++i) {
+        runFrame();
+        if (std::find(warmStorage.begin(), warmStorage.end(), currentStorage()) == warmStorage.end()) {
+            ++framesOnNewStorage;
+        }
+    }
+    auto allocations = heapAllocationCount.load() - before;
+
+    std::cout << "Analyzer steady state: " << allocations
+              << (AllocationHooks::countsMallocFamily ? " heap allocations" : " operator new calls")
+              << " and " << framesOnNewStorage << " frames on new FFT storage in "
+              << numFrames << " frames" << std::endl;
+    return allocations == 0 && framesOnNewStorage == 0;
+}
+
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // Results go to the file given with --json, or to stdout after the tables.
+    juce::ArgumentList arguments(argc, argv);
+    juce::ScopedJuceInitialiser_GUI libraryInitialiser;
+
+    juce::Array<juce::var> results;
+    benchmarkAnalyzerTap(results);
+    benchmarkStereoSpectra(results);
+    auto processBlockAllocations = benchmarkProcessBlock(results);
+    benchmarkFFTData(results);
+    benchmarkPathGeneration(results);
+    benchmarkResponseCurve(results);
+
+    auto analyzerPassed = checkAnalyzerFramesDoNotAllocate();
+    // operator new alone misses HeapBlock's mallocs, so a zero from it proves nothing.
+    if (!AllocationHooks::countsMallocFamily) {
+        std::cout << "malloc isn't counted in this build, so the allocation checks can't pass; "
+                     "use a debug Windows build or glibc" << std::endl;
+    }
+    auto passed = AllocationHooks::countsMallocFamily && analyzerPassed && processBlockAllocations == 0;
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("results", results);
+    report->setProperty("mallocFamilyCounted", AllocationHooks::countsMallocFamily);
+    report->setProperty(juce::String("processBlock") + (AllocationHooks::countsMallocFamily ? "HeapAllocations" : "OperatorNewCalls"),
+                        (juce::int64)processBlockAllocations);
+    report->setProperty("analyzerSteadyStateAllocationFree", analyzerPassed);
+    report->setProperty("audioThreadGuardAllocations", AudioThreadGuard::getAllocationCount());
+    report->setProperty("audioThreadGuardLocks", AudioThreadGuard::getLockCount());
+    report->setProperty("audioThreadGuardWaits", AudioThreadGuard::getWaitCount());
+    report->setProperty("passed", passed);
+    auto json = juce::JSON::toString(juce::var(report.get()));
+
+    if (arguments.containsOption("--json")) {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--json"));
+        if (!file.replaceWithText(json)) {
+            std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else {
+        std::cout << json << std::endl;
+    }
+
+    return passed ? 0 : 1;
+}
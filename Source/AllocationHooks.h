@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    Replacements for every replaceable global allocation and deallocation
+    function, built on malloc and free. Define SIMPLEEQ_ON_ALLOCATION() before
+    including this from exactly one translation unit of a binary; it runs
+    before every allocation, whichever form of new made it.
+
+    Define SIMPLEEQ_HOOK_MALLOC_FAMILY to 1 as well to also count malloc,
+    calloc, realloc and the aligned forms, which juce::HeapBlock (and so
+    Array, Path and AudioBuffer) calls directly. That is only possible with
+    glibc, where malloc itself is interposed, and with the Windows debug CRT,
+    through its allocation hook; AllocationHooks::countsMallocFamily says
+    whether this build does. Both are process-wide, not limited to the binary
+    that includes this.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#if JUCE_WINDOWS
+ #include <malloc.h>
+#endif
+
+#ifndef SIMPLEEQ_ON_ALLOCATION
+ #error "Define SIMPLEEQ_ON_ALLOCATION() before including AllocationHooks.h"
+#endif
+
+#ifndef SIMPLEEQ_HOOK_MALLOC_FAMILY
+ #define SIMPLEEQ_HOOK_MALLOC_FAMILY 0
+#endif
+
+#if SIMPLEEQ_HOOK_MALLOC_FAMILY && defined(__GLIBC__)
+ #define SIMPLEEQ_MALLOC_HOOK_GLIBC 1
+#elif SIMPLEEQ_HOOK_MALLOC_FAMILY && JUCE_WINDOWS && defined(_DEBUG)
+ #define SIMPLEEQ_MALLOC_HOOK_CRT 1
+ #include <crtdbg.h>
+#endif
+
+#if SIMPLEEQ_MALLOC_HOOK_GLIBC
+// glibc's own entry points, exported so that a replacement malloc can forward to them.
+extern "C" {
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+void* __libc_memalign(std::size_t, std::size_t);
+void __libc_free(void*);
+}
+#endif
+
+namespace AllocationHooks {
+#if SIMPLEEQ_MALLOC_HOOK_GLIBC || SIMPLEEQ_MALLOC_HOOK_CRT
+constexpr bool countsMallocFamily = true;
+#else
+constexpr bool countsMallocFamily = false;
+#endif
+
+inline void* allocate(std::size_t size) noexcept {
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+inline void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+    size = size == 0 ? 1 : size;
+   #if JUCE_WINDOWS
+    return _aligned_malloc(size, (std::size_t)alignment);
+   #else
+    // posix_memalign rejects alignments below a pointer's.
+    auto bytes = (std::size_t)alignment < sizeof(void*) ? sizeof(void*) : (std::size_t)alignment;
+    void* p = nullptr;
+    return posix_memalign(&p, bytes, size) == 0 ? p : nullptr;
+   #endif
+}
+
+// Aligned blocks have to go back the way they came: Windows keeps them apart from malloc's.
+inline void freeAligned(void* p) noexcept {
+   #if JUCE_WINDOWS
+    _aligned_free(p);
+   #else
+    std::free(p);
+   #endif
+}
+
+// When malloc itself is counted, new is counted on its way through it.
+inline void noteNew() noexcept {
+    if constexpr (!countsMallocFamily) {
+        SIMPLEEQ_ON_ALLOCATION();
+    }
+}
+
+#if SIMPLEEQ_MALLOC_HOOK_CRT
+// The debug CRT reports every heap block it hands out or resizes; its own (_CRT_BLOCK) ones are
+// made while it reports and must not be counted. Returning nonzero lets the allocation go ahead.
+inline _CRT_ALLOC_HOOK previousCrtHook = nullptr;
+
+inline int __cdecl crtAllocationHook(int type, void* block, std::size_t size, int blockType, long request,
+                                     const unsigned char* file, int line) {
+    if ((type == _HOOK_ALLOC || type == _HOOK_REALLOC) && blockType != _CRT_BLOCK) {
+        SIMPLEEQ_ON_ALLOCATION();
+    }
+    return previousCrtHook != nullptr ? previousCrtHook(type, block, size, blockType, request, file, line) : 1;
+}
+
+// Installed for as long as this binary is loaded, so that unloading it can't leave the CRT
+// calling into freed code.
+struct CrtHookInstaller {
+    CrtHookInstaller() { previousCrtHook = _CrtSetAllocHook(crtAllocationHook); }
+    ~CrtHookInstaller() {
+        if (_CrtGetAllocHook() == crtAllocationHook) {
+            _CrtSetAllocHook(previousCrtHook);
+        }
+    }
+};
+
+inline const CrtHookInstaller crtHookInstaller;
+#endif
+}
+
+#if SIMPLEEQ_MALLOC_HOOK_GLIBC
+extern "C" {
+void* malloc(std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    return __libc_realloc(p, size);
+}
+
+void free(void* p) { __libc_free(p); }
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    auto* p = __libc_memalign(alignment, size);
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+    *result = p;
+    return 0;
+}
+
+void* memalign(std::size_t alignment, std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) {
+    SIMPLEEQ_ON_ALLOCATION();
+    return __libc_memalign(alignment, size);
+}
+}
+#endif
+
+void* operator new(std::size_t size) {
+    AllocationHooks::noteNew();
+    if (auto* p = AllocationHooks::allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    AllocationHooks::noteNew();
+    if (auto* p = AllocationHooks::allocateAligned(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    AllocationHooks::noteNew();
+    return AllocationHooks::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    AllocationHooks::noteNew();
+    return AllocationHooks::allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept { return operator new(size, alignment, tag); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { AllocationHooks::freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AllocationHooks::freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { AllocationHooks::freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { AllocationHooks::freeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { AllocationHooks::freeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { AllocationHooks::freeAligned(p); }
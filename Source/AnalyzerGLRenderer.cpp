@@ -0,0 +1,305 @@
+/*
+  ==============================================================================
+
+    OpenGL backend for the response curve component's analyzer traces.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerGLRenderer.h"
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+
+void AnalyzerGLRenderer::setLayout(juce::Rectangle<int> componentArea, juce::Rectangle<int> clipArea, juce::Point<float> traceOrigin, juce::Rectangle<int> targetBounds)
+{
+    const juce::SpinLock::ScopedLockType sl(stateLock);
+    pendingState.componentArea = componentArea;
+    pendingState.clipArea = clipArea;
+    pendingState.traceOrigin = traceOrigin;
+    pendingState.targetBounds = targetBounds;
+}
+
+void AnalyzerGLRenderer::setBackground(const juce::Image& image)
+{
+    const juce::SpinLock::ScopedLockType sl(stateLock);
+    pendingState.background = image;
+    backgroundChanged = true;
+}
+
+void AnalyzerGLRenderer::setTrace(int index, const juce::Path& path, juce::Colour colour)
+{
+    jassert(juce::isPositiveAndBelow(index, numTraces));
+
+    const juce::SpinLock::ScopedLockType sl(stateLock);
+    auto& vertices = pendingState.traceVertices[(size_t)index];
+    vertices.clear();
+
+    juce::Path::Iterator it(path);
+    while (it.next()) {
+        if (it.elementType == juce::Path::Iterator::startNewSubPath || it.elementType == juce::Path::Iterator::lineTo) {
+            vertices.push_back(it.x1);
+            vertices.push_back(it.y1);
+        }
+    }
+
+    pendingState.traceColours[(size_t)index] = colour;
+    verticesChanged = true;
+}
+
+void AnalyzerGLRenderer::setTracesVisible(bool shouldBeVisible)
+{
+    const juce::SpinLock::ScopedLockType sl(stateLock);
+    pendingState.tracesVisible = shouldBeVisible;
+}
+
+void AnalyzerGLRenderer::newOpenGLContextCreated()
+{
+    using namespace juce::gl;
+    auto& context = *juce::OpenGLContext::getCurrentContext();
+
+    // Positions are in the target component's logical pixels, offset by the trace origin.
+    const char* vertexShader =
+        "attribute vec2 position;\n"
+        "uniform vec2 offset;\n"
+        "uniform vec2 viewportSize;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 p = position + offset;\n"
+        "    gl_Position = vec4(2.0 * p.x / viewportSize.x - 1.0, 1.0 - 2.0 * p.y / viewportSize.y, 0.0, 1.0);\n"
+        "}\n";
+
+    const char* fragmentShader =
+        "uniform " JUCE_MEDIUMP " vec4 colour;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = colour;\n"
+        "}\n";
+
+    // The background quad, textured with the component's pre-rendered background image.
+    const char* backgroundVertexShader =
+        "attribute vec2 position;\n"
+        "attribute vec2 textureCoordIn;\n"
+        "uniform vec2 viewportSize;\n"
+        "varying vec2 textureCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    textureCoord = textureCoordIn;\n"
+        "    gl_Position = vec4(2.0 * position.x / viewportSize.x - 1.0, 1.0 - 2.0 * position.y / viewportSize.y, 0.0, 1.0);\n"
+        "}\n";
+
+    const char* backgroundFragmentShader =
+        "varying " JUCE_MEDIUMP " vec2 textureCoord;\n"
+        "uniform sampler2D backgroundTexture;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = texture2D(backgroundTexture, textureCoord);\n"
+        "}\n";
+
+    auto compile = [&context](const char* vertex, const char* fragment) -> std::unique_ptr<juce::OpenGLShaderProgram> {
+        auto program = std::make_unique<juce::OpenGLShaderProgram>(context);
+        if (!program->addVertexShader(juce::OpenGLHelpers::translateVertexShaderToV3(vertex))
+            || !program->addFragmentShader(juce::OpenGLHelpers::translateFragmentShaderToV3(fragment))
+            || !program->link()) {
+            DBG(program->getLastError());
+            return nullptr;
+        }
+        return program;
+    };
+
+    auto newShader = compile(vertexShader, fragmentShader);
+    auto newBackgroundShader = compile(backgroundVertexShader, backgroundFragmentShader);
+    if (newShader == nullptr || newBackgroundShader == nullptr) {
+        // Stay not ready; the component keeps painting the analyzer in software.
+        return;
+    }
+
+    shader = std::move(newShader);
+    positionAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "position");
+    offsetUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "offset");
+    viewportUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "viewportSize");
+    colourUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "colour");
+
+    backgroundShader = std::move(newBackgroundShader);
+    backgroundPositionAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*backgroundShader, "position");
+    backgroundTextureCoordAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*backgroundShader, "textureCoordIn");
+    backgroundViewportUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*backgroundShader, "viewportSize");
+    backgroundSamplerUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*backgroundShader, "backgroundTexture");
+
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &backgroundVertexBuffer);
+    {
+        // The first frame has to upload whatever was set before the context existed.
+        const juce::SpinLock::ScopedLockType sl(stateLock);
+        verticesChanged = true;
+        backgroundChanged = true;
+    }
+    ready = true;
+}
+
+void AnalyzerGLRenderer::renderOpenGL()
+{
+    using namespace juce::gl;
+
+    if (shader == nullptr) {
+        return;
+    }
+
+    auto uploadVertices = false, uploadBackground = false;
+    {
+        // Vector assignment reuses the render state's storage once it has grown.
+        const juce::SpinLock::ScopedLockType sl(stateLock);
+        renderState.componentArea = pendingState.componentArea;
+        renderState.clipArea = pendingState.clipArea;
+        renderState.traceOrigin = pendingState.traceOrigin;
+        renderState.targetBounds = pendingState.targetBounds;
+        renderState.tracesVisible = pendingState.tracesVisible;
+        if (verticesChanged) {
+            renderState.traceVertices = pendingState.traceVertices;
+            renderState.traceColours = pendingState.traceColours;
+            verticesChanged = false;
+            uploadVertices = true;
+        }
+        if (backgroundChanged) {
+            renderState.background = pendingState.background;
+            backgroundChanged = false;
+            uploadBackground = true;
+        }
+    }
+
+    if (uploadBackground) {
+        if (renderState.background.isValid()) {
+            backgroundTexture.loadImage(renderState.background);
+            backgroundImageSize = { renderState.background.getWidth(), renderState.background.getHeight() };
+        }
+        else {
+            backgroundTexture.release();
+        }
+        // The texture holds the pixels now.
+        renderState.background = {};
+    }
+
+    auto& context = *juce::OpenGLContext::getCurrentContext();
+    auto scale = (float)context.getRenderingScale();
+    auto target = renderState.targetBounds;
+    if (target.isEmpty() || backgroundTexture.getTextureID() == 0) {
+        return;
+    }
+
+    drawBackground(target);
+
+    if (!renderState.tracesVisible) {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    if (uploadVertices) {
+        size_t totalFloats = 0;
+        for (auto& vertices : renderState.traceVertices) {
+            totalFloats += vertices.size();
+        }
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(totalFloats * sizeof(float)), nullptr, GL_STREAM_DRAW);
+
+        size_t offset = 0;
+        for (auto& vertices : renderState.traceVertices) {
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(offset * sizeof(float)), (GLsizeiptr)(vertices.size() * sizeof(float)), vertices.data());
+            offset += vertices.size();
+        }
+    }
+
+    auto clip = renderState.clipArea + renderState.componentArea.getPosition();
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(juce::roundToInt(scale * (float)clip.getX()),
+        juce::roundToInt(scale * (float)(target.getHeight() - clip.getBottom())),
+        juce::roundToInt(scale * (float)clip.getWidth()),
+        juce::roundToInt(scale * (float)clip.getHeight()));
+
+    shader->use();
+    auto origin = renderState.traceOrigin + renderState.componentArea.getPosition().toFloat();
+    offsetUniform->set(origin.x, origin.y);
+    viewportUniform->set((GLfloat)target.getWidth(), (GLfloat)target.getHeight());
+
+    glVertexAttribPointer((GLuint)positionAttribute->attributeID, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    glEnableVertexAttribArray((GLuint)positionAttribute->attributeID);
+
+    GLint first = 0;
+    for (size_t i = 0; i < renderState.traceVertices.size(); ++i) {
+        auto numVertices = (GLsizei)(renderState.traceVertices[i].size() / 2);
+        auto colour = renderState.traceColours[i];
+        colourUniform->set(colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha());
+        glDrawArrays(GL_LINE_STRIP, first, numVertices);
+        first += numVertices;
+    }
+
+    glDisableVertexAttribArray((GLuint)positionAttribute->attributeID);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void AnalyzerGLRenderer::drawBackground(juce::Rectangle<int> target)
+{
+    using namespace juce::gl;
+
+    // loadImage flips the image and, where the texture had to be rounded up in size, leaves it in
+    // the top-left corner: its top row is at v = 1.
+    auto area = renderState.componentArea.toFloat();
+    auto u = (float)backgroundImageSize.x / (float)backgroundTexture.getWidth();
+    auto vBottom = 1.f - (float)backgroundImageSize.y / (float)backgroundTexture.getHeight();
+    const std::array<float, 16> quad{
+        area.getX(), area.getY(), 0.f, 1.f,
+        area.getRight(), area.getY(), u, 1.f,
+        area.getX(), area.getBottom(), 0.f, vBottom,
+        area.getRight(), area.getBottom(), u, vBottom
+    };
+
+    backgroundShader->use();
+    backgroundViewportUniform->set((GLfloat)target.getWidth(), (GLfloat)target.getHeight());
+    glActiveTexture(GL_TEXTURE0);
+    backgroundTexture.bind();
+    backgroundSamplerUniform->set((GLint)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, backgroundVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(quad), quad.data(), GL_STREAM_DRAW);
+
+    auto position = (GLuint)backgroundPositionAttribute->attributeID;
+    auto textureCoord = (GLuint)backgroundTextureCoordAttribute->attributeID;
+    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+    glVertexAttribPointer(textureCoord, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (GLvoid*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(position);
+    glEnableVertexAttribArray(textureCoord);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glDisableVertexAttribArray(position);
+    glDisableVertexAttribArray(textureCoord);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    backgroundTexture.unbind();
+}
+
+void AnalyzerGLRenderer::openGLContextClosing()
+{
+    using namespace juce::gl;
+
+    ready = false;
+    if (vertexBuffer != 0) {
+        glDeleteBuffers(1, &vertexBuffer);
+        vertexBuffer = 0;
+    }
+    if (backgroundVertexBuffer != 0) {
+        glDeleteBuffers(1, &backgroundVertexBuffer);
+        backgroundVertexBuffer = 0;
+    }
+    backgroundTexture.release();
+    positionAttribute.reset();
+    offsetUniform.reset();
+    viewportUniform.reset();
+    colourUniform.reset();
+    shader.reset();
+    backgroundPositionAttribute.reset();
+    backgroundTextureCoordAttribute.reset();
+    backgroundViewportUniform.reset();
+    backgroundSamplerUniform.reset();
+    backgroundShader.reset();
+    renderState.background = {};
+}
+
+#endif
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    OpenGL backend for the response curve component's analyzer traces.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+
+// Draws the response curve component's static background and the analyzer traces under the
+// editor's component layer. The background is uploaded as a texture whenever it is re-rendered
+// (on resize or a scale change) and drawn as a single quad; the traces are uploaded as a vertex
+// buffer and drawn as line strips, so neither goes through the software renderer per frame.
+//
+// set...() calls come from the message thread; the OpenGLRenderer callbacks run on the GL thread
+// and render from the latest state they were given.
+struct AnalyzerGLRenderer : juce::OpenGLRenderer {
+    static constexpr int numTraces = 2;
+
+    // Where the component and its analyzer sit in the GL context's target component.
+    void setLayout(juce::Rectangle<int> componentArea, juce::Rectangle<int> clipArea, juce::Point<float> traceOrigin, juce::Rectangle<int> targetBounds);
+    void setBackground(const juce::Image& image);
+    // Only the vertices of the path are used; analyzer paths are a single polyline.
+    void setTrace(int index, const juce::Path& path, juce::Colour colour);
+    void setTracesVisible(bool shouldBeVisible);
+
+    // True once the context exists and the shader compiled, until the context closes.
+    bool isReady() const { return ready.load(); }
+
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+
+private:
+    struct State {
+        juce::Rectangle<int> componentArea, clipArea, targetBounds;
+        juce::Point<float> traceOrigin;
+        juce::Image background;
+        std::array<std::vector<float>, numTraces> traceVertices;
+        std::array<juce::Colour, numTraces> traceColours;
+        bool tracesVisible = false;
+    };
+
+    juce::SpinLock stateLock;
+    State pendingState;
+    bool verticesChanged = false, backgroundChanged = false;
+
+    // Only touched on the GL thread.
+    State renderState;
+    std::unique_ptr<juce::OpenGLShaderProgram> shader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> positionAttribute;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> offsetUniform, viewportUniform, colourUniform;
+    juce::uint32 vertexBuffer = 0;
+
+    std::unique_ptr<juce::OpenGLShaderProgram> backgroundShader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> backgroundPositionAttribute, backgroundTextureCoordAttribute;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> backgroundViewportUniform, backgroundSamplerUniform;
+    juce::OpenGLTexture backgroundTexture;
+    juce::Point<int> backgroundImageSize;
+    juce::uint32 backgroundVertexBuffer = 0;
+    void drawBackground(juce::Rectangle<int> target);
+
+    std::atomic<bool> ready{ false };
+};
+
+#endif
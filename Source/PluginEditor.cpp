@@ -24,25 +24,16 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
 
     if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider)) {
         auto center = bounds.getCentre();
-        Path p;
-
-        Rectangle<float> r;
-        r.setLeft(center.getX() - 2);
-        r.setRight(center.getX() + 2);
-        r.setTop(bounds.getY());
-        r.setBottom(center.getY() - rswl->getTextHeight()*1.5);
-
-        p.addRoundedRectangle(r, 2.f);
 
         jassert(rotaryStartAngle < rotaryEndAngle);
         auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
-        p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
-        g.fillPath(p);
+        g.fillPath(getPointerPath(bounds, (float)rswl->getTextHeight()), AffineTransform::rotated(sliderAngRad, center.getX(), center.getY()));
 
         g.setFont(rswl->getTextHeight());
         auto text = rswl->getDisplayString();
         auto strWidth = g.getCurrentFont().getStringWidth(text);
 
+        Rectangle<float> r;
         r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
         r.setCentre(bounds.getCentre());
         g.setColour(enabled ? Colour(97u, 18u, 167u) : Colours::darkgrey);
@@ -58,22 +49,15 @@ void LookAndFeel::drawToggleButton(juce::Graphics& g, juce::ToggleButton& toggle
     //TODO Hittest to clean up bounding box behaviour
 
     if (auto* pb = dynamic_cast<PowerButton*>(&toggleButton)) {
-        Path powerButton;
         auto bounds = toggleButton.getLocalBounds();
         auto size = jmin(bounds.getWidth(), bounds.getHeight()) - 6;
         auto r = bounds.withSizeKeepingCentre(size, size).toFloat();
 
-        float ang = 30.f;
-        size -= 6;
-        powerButton.addCentredArc(r.getCentreX(), r.getCentreY(), size * 0.5, size * 0.5, 0, degreesToRadians(ang), degreesToRadians(360 - ang), true); //Circle part of symbol
-        powerButton.startNewSubPath(r.getCentreX(), r.getY());
-        powerButton.lineTo(r.getCentre());
-
         PathStrokeType pst(2.f, PathStrokeType::JointStyle::curved);
 
         auto color = toggleButton.getToggleState() ? Colours::dimgrey : Colour(0u, 172u, 1u);
         g.setColour(color);
-        g.strokePath(powerButton, pst);
+        g.strokePath(getPowerSymbolPath(bounds), pst);
         g.drawEllipse(r, 2);
     }
     else if (auto* analyzerButton = dynamic_cast<AnalyzerButton*>(&toggleButton)) {
@@ -83,14 +67,60 @@ void LookAndFeel::drawToggleButton(juce::Graphics& g, juce::ToggleButton& toggle
         
         auto bounds = toggleButton.getLocalBounds();
         g.drawRect(bounds);
-        auto insetRect = bounds.reduced(4);
 
-        Path randomPath;
-        
         g.strokePath(analyzerButton->randomPath, PathStrokeType(1.f));
     }
 }
 
+const juce::Path& LookAndFeel::getPointerPath(juce::Rectangle<float> sliderBounds, float textHeight) {
+    for (auto& entry : pointerPaths) {
+        if (entry.bounds == sliderBounds && entry.textHeight == textHeight) {
+            return entry.path;
+        }
+    }
+    if (pointerPaths.size() >= maxCachedPaths) {
+        pointerPaths.clear();
+    }
+
+    // The pointer at twelve o'clock; drawRotarySlider rotates it into place.
+    auto center = sliderBounds.getCentre();
+    juce::Rectangle<float> r;
+    r.setLeft(center.getX() - 2);
+    r.setRight(center.getX() + 2);
+    r.setTop(sliderBounds.getY());
+    r.setBottom(center.getY() - textHeight * 1.5f);
+
+    juce::Path p;
+    p.addRoundedRectangle(r, 2.f);
+    pointerPaths.push_back({ sliderBounds, textHeight, std::move(p) });
+    return pointerPaths.back().path;
+}
+
+const juce::Path& LookAndFeel::getPowerSymbolPath(juce::Rectangle<int> buttonBounds) {
+    using namespace juce;
+    for (auto& entry : powerSymbolPaths) {
+        if (entry.bounds == buttonBounds) {
+            return entry.path;
+        }
+    }
+    if (powerSymbolPaths.size() >= maxCachedPaths) {
+        powerSymbolPaths.clear();
+    }
+
+    auto size = jmin(buttonBounds.getWidth(), buttonBounds.getHeight()) - 6;
+    auto r = buttonBounds.withSizeKeepingCentre(size, size).toFloat();
+
+    Path powerButton;
+    float ang = 30.f;
+    size -= 6;
+    powerButton.addCentredArc(r.getCentreX(), r.getCentreY(), size * 0.5, size * 0.5, 0, degreesToRadians(ang), degreesToRadians(360 - ang), true); //Circle part of symbol
+    powerButton.startNewSubPath(r.getCentreX(), r.getY());
+    powerButton.lineTo(r.getCentre());
+
+    powerSymbolPaths.push_back({ buttonBounds, std::move(powerButton) });
+    return powerSymbolPaths.back().path;
+}
+
 void RotarySliderWithLabels::paint(juce::Graphics& g) {
     using namespace juce;
 
@@ -175,132 +205,397 @@ juce::String RotarySliderWithLabels::getDisplayString() const {
 
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEqAudioProcessor& p) : audioProcessor(p),
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+pathProducer(audioProcessor.leftChannelFifo, audioProcessor.rightChannelFifo)
 {
     const auto& params = audioProcessor.getParameters();
     for (auto param : params) {
         param->addListener(this);
     }
 
+    toggleAnalysisEnablement(audioProcessor.apvts.getRawParameterValue("Analyzer Enabled")->load() > 0.5f);
+
     updateChain();
-    startTimerHz(60);
+    setMaxFrameRate(getRequestedFrameRate());
 }
 
 ResponseCurveComponent::~ResponseCurveComponent() {
+    toggleAnalysisEnablement(false);
+
     const auto& params = audioProcessor.getParameters();
     for (auto param : params) {
         param->removeListener(this);
     }
 }
 
+void ResponseCurveComponent::toggleAnalysisEnablement(bool enabled) {
+    if (enabled == showFFTAnalysis) {
+        return;
+    }
+    showFFTAnalysis = enabled;
+    needsRepaint = true;
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    glRenderer.setTracesVisible(enabled);
+#endif
+
+    if (enabled) {
+        audioProcessor.addAnalyzerConsumer();
+    }
+    else {
+        audioProcessor.removeAnalyzerConsumer();
+    }
+}
+
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue) {
     parametersChanged.set(true);
 }
 
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void PathProducer::setRenderParameters(juce::Rectangle<float> fftBounds, std::shared_ptr<const FrequencyAxis> axis)
+{
+    const juce::SpinLock::ScopedLockType sl(renderParametersLock);
+    renderBounds = fftBounds;
+    renderAxis = std::move(axis);
+}
+
+void PathProducer::process()
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+    juce::Rectangle<float> fftBounds;
+    std::shared_ptr<const FrequencyAxis> axis;
     {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
-        {
-            auto size = tempIncomingBuffer.getNumSamples();
+        const juce::SpinLock::ScopedLockType sl(renderParametersLock);
+        fftBounds = renderBounds;
+        axis = renderAxis;
+    }
+    if (fftBounds.isEmpty() || axis == nullptr || axis->getSampleRate() <= 0) {
+        return;
+    }
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                monoBuffer.getReadPointer(0, size),
-                monoBuffer.getNumSamples() - size);
+    if (requestedOrder.load() != currentOrder) {
+        currentOrder = requestedOrder.load();
+        samplesSinceLastFFT = 0;
+    }
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                tempIncomingBuffer.getReadPointer(0, 0),
-                size);
+    const auto fftSize = 1 << currentOrder;
+    const auto mode = channelMode.load();
+    const auto latestOnly = analyzeLatestOnly.load();
+    const auto hopSize = juce::jmax(1, fftSize / overlapFactor.load());
 
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+    if (latestOnly) {
+        // Buffers older than one window's worth would be overwritten in the history straight away.
+        for (auto* fifo : channelFifos) {
+            auto buffersPerWindow = (fftSize + fifo->getSize() - 1) / juce::jmax(1, fifo->getSize());
+            fifo->discardAudioBuffers(fifo->getNumCompleteBuffersAvailable() - buffersPerWindow);
         }
     }
-    //This causes plug in to crash
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    const auto binWidth = sampleRate / double(fftSize);
 
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+    // Both FIFOs are filled from the same processBlock calls, so they move in step.
+    auto numSpectra = 0;
+    while (channelFifos[0]->getNumCompleteBuffersAvailable() > 0 && channelFifos[1]->getNumCompleteBuffersAvailable() > 0)
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))
-        {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+        auto size = 0;
+        for (int ch = 0; ch < numChannels; ++ch) {
+            if (!channelFifos[(size_t)ch]->getAudioBuffer(incomingBuffer)) {
+                continue;
+            }
+            size = incomingBuffer.getNumSamples();
+            histories[(size_t)ch].append(incomingBuffer.getReadPointer(0), size);
+        }
+
+        samplesSinceLastFFT += size;
+        if (!latestOnly && samplesSinceLastFFT >= hopSize) {
+            produceSpectra(mode);
+            accumulateSpectra(numSpectra++ == 0);
+            samplesSinceLastFFT %= hopSize;
         }
     }
 
-    while (pathProducer.getNumPathsAvailable() > 0)
-    {
-        pathProducer.getPath(leftChannelFFTPath);
+    if (latestOnly && samplesSinceLastFFT > 0) {
+        produceSpectra(mode);
+        accumulateSpectra(numSpectra++ == 0);
+        samplesSinceLastFFT = 0;
+    }
+
+    // One path per frame, however many hops went into it.
+    if (numSpectra > 0) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            pathGenerators[(size_t)ch].generatePath(frameSpectra[(size_t)ch], fftBounds, currentOrder, *axis, -48.f);
+        }
+    }
+}
+
+void PathProducer::accumulateSpectra(bool isFirstInFrame)
+{
+    const auto numBins = (1 << currentOrder) / 2;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto* frame = frameSpectra[(size_t)ch].data();
+        auto* spectrum = fftData[(size_t)ch].data();
+        if (isFirstInFrame) {
+            juce::FloatVectorOperations::copy(frame, spectrum, numBins);
+        }
+        else {
+            juce::FloatVectorOperations::max(frame, frame, spectrum, numBins);
+        }
+    }
+}
+
+void PathProducer::produceSpectra(AnalyzerChannelMode mode)
+{
+    packedFFT.perform(currentOrder, histories[0], histories[1],
+        mode == AnalyzerChannelMode::packedMidSide,
+        fftData[0], fftData[1], -48.f);
+}
+
+bool PathProducer::pullLatestPaths()
+{
+    auto pulled = false;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto& generator = pathGenerators[(size_t)ch];
+        while (generator.getNumPathsAvailable() > 0)
+        {
+            pulled = generator.getPath(paths[(size_t)ch]) || pulled;
+        }
     }
+    return pulled;
 }
 
 void ResponseCurveComponent::timerCallback() {
+    updateRenderingMode();
+
+    auto requestedFrameRate = getRequestedFrameRate();
+    if (requestedFrameRate != maxFrameRate) {
+        setMaxFrameRate(requestedFrameRate);
+    }
+
+    if (frequencyAxis != nullptr && frequencyAxis->getSampleRate() != audioProcessor.getSampleRate()) {
+        updateFrequencyAxis();
+        parametersChanged.set(true);
+    }
+
+    // A change of oversampling only reaches the processor after these parameters have moved.
+    if (chainDesigned && getResponseSampleRate() != chainSampleRate) {
+        parametersChanged.set(true);
+    }
+
     if (showFFTAnalysis) {
         auto fftBounds = getDrawArea().toFloat();
-        auto sampleRate = audioProcessor.getSampleRate();
 
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        pathProducer.setRenderParameters(fftBounds, frequencyAxis);
+
+        auto resolution = (int)audioProcessor.apvts.getRawParameterValue("Analyzer Resolution")->load();
+        auto order = static_cast<FFTOrder>(FFTOrder::order2048 + juce::jlimit(0, FFTEngines::numOrders - 1, resolution));
+        pathProducer.setFFTOrder(order);
+
+        auto midSide = audioProcessor.apvts.getRawParameterValue("Analyzer Mode")->load() > 0.5f;
+        pathProducer.setChannelMode(midSide ? AnalyzerChannelMode::packedMidSide : AnalyzerChannelMode::packedStereo);
+
+        // Choice 0 is one FFT per frame; the others run one every fftSize / 2^choice samples.
+        auto overlap = juce::jlimit(0, 3, (int)audioProcessor.apvts.state.getProperty(StateProperties::analyzerOverlap, StateProperties::analyzerOverlapDefault));
+        pathProducer.setAnalysisMode(overlap == 0, 1 << overlap);
+
+        auto pulled = pathProducer.pullLatestPaths();
+        needsRepaint = needsRepaint || pulled;
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+        if (renderingWithOpenGL && pulled) {
+            glRenderer.setTrace(0, pathProducer.getPath(0), leftTraceColour);
+            glRenderer.setTrace(1, pathProducer.getPath(1), rightTraceColour);
+        }
+#endif
     }
 
     if (parametersChanged.compareAndSetBool(false, true)) {
         updateChain();
         updateResponseCurve();
+        needsRepaint = true;
     }
-    
 
-    repaint();
+    ++ticksSinceRepaint;
+    if (repaintPending) {
+        // The last frame still hasn't been painted by the time the next one is due.
+        if (ticksSinceRepaint > frameInterval) {
+            frameInterval = juce::jmin(frameInterval + 1, maxFrameInterval);
+        }
+        // A repaint requested while hidden may never arrive; stop waiting for it eventually.
+        if (ticksSinceRepaint < 4 * maxFrameInterval) {
+            return;
+        }
+        repaintPending = false;
+    }
+
+    if (needsRepaint && ticksSinceRepaint >= frameInterval) {
+        // The labels around the border never change, so only the inside needs painting.
+        repaint(getRenderArea());
+        needsRepaint = false;
+        repaintPending = true;
+        ticksSinceRepaint = 0;
+    }
+}
+
+void ResponseCurveComponent::setOpenGLRequested(bool shouldUseOpenGL) {
+    openGLRequested = shouldUseOpenGL;
+    updateRenderingMode();
+}
+
+void ResponseCurveComponent::updateRenderingMode() {
+    auto useOpenGL = false;
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    useOpenGL = openGLRequested && glRenderer.isReady();
+#endif
+    if (useOpenGL == renderingWithOpenGL) {
+        return;
+    }
+    renderingWithOpenGL = useOpenGL;
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (useOpenGL) {
+        updateGLLayout();
+        glRenderer.setBackground(background);
+        glRenderer.setTrace(0, pathProducer.getPath(0), leftTraceColour);
+        glRenderer.setTrace(1, pathProducer.getPath(1), rightTraceColour);
+        glRenderer.setTracesVisible(showFFTAnalysis);
+    }
+#endif
+
+    // Below the GL layer, this component and the editor behind it must leave the area unpainted.
+    setOpaque(!useOpenGL);
+    if (auto* parent = getParentComponent()) {
+        parent->repaint(getBoundsInParent());
+    }
+    needsRepaint = true;
+}
+
+void ResponseCurveComponent::updateGLLayout() {
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    auto* parent = getParentComponent();
+    auto targetBounds = parent != nullptr ? parent->getLocalBounds() : getLocalBounds();
+    glRenderer.setLayout(getBoundsInParent(), getRenderArea().reduced(1), getDrawArea().getPosition().toFloat(), targetBounds);
+#endif
+}
+
+void ResponseCurveComponent::setMaxFrameRate(int framesPerSecond) {
+    maxFrameRate = juce::jlimit(1, 120, framesPerSecond);
+    startTimerHz(maxFrameRate);
+}
+
+int ResponseCurveComponent::getRequestedFrameRate() const {
+    const auto& frameRates = StateProperties::analyzerFrameRates;
+    auto index = juce::jlimit(0, (int)frameRates.size() - 1,
+                              (int)audioProcessor.apvts.state.getProperty(StateProperties::analyzerFrameRate, StateProperties::analyzerFrameRateDefault));
+    return frameRates[(size_t)index];
+}
+
+void ResponseCurveComponent::updateFrameInterval(double paintMilliseconds) {
+    repaintPending = false;
+    averagePaintMilliseconds += 0.1 * (paintMilliseconds - averagePaintMilliseconds);
+
+    // Leave at least half of each frame to the rest of the UI and the host. Slow down as soon as
+    // painting gets too expensive, but only speed back up one step per frame.
+    auto frameMilliseconds = 1000.0 / maxFrameRate;
+    auto wantedInterval = juce::jlimit(1, maxFrameInterval, (int)std::ceil(2.0 * averagePaintMilliseconds / frameMilliseconds));
+    frameInterval = wantedInterval > frameInterval ? wantedInterval : juce::jmax(wantedInterval, frameInterval - 1);
+}
+
+double ResponseCurveComponent::getResponseSampleRate() const {
+    // Oversampled bands are designed at the raised rate, and their response differs near Nyquist.
+    auto chainRate = audioProcessor.getChainSampleRate();
+    return chainRate > 0 ? chainRate : audioProcessor.getSampleRate();
 }
 
 void ResponseCurveComponent::updateChain() {
     auto chainSettings = getChainSettings(audioProcessor.apvts);
+    auto sampleRate = getResponseSampleRate();
+    auto redesignAll = !chainDesigned || sampleRate != chainSampleRate;
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    if (redesignAll || chainSettings.peakBypassed != chainDesignSettings.peakBypassed
+        || peakDesignChanged(chainSettings, chainDesignSettings)) {
+        monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
 
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get < ChainPositions::Peak>().coefficients, peakCoefficients);
+        auto peakCoefficients = makePeakFilter(chainSettings, sampleRate);
+        updateCoefficients(monoChain.get < ChainPositions::Peak>().coefficients, peakCoefficients);
+        peakResponseDirty = true;
+    }
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    if (redesignAll || chainSettings.lowCutBypassed != chainDesignSettings.lowCutBypassed
+        || lowCutDesignChanged(chainSettings, chainDesignSettings)) {
+        monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
 
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
+        auto lowCutCoefficients = makeLowCutFilter(chainSettings, sampleRate);
+        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
+        lowCutResponseDirty = true;
+    }
+
+    if (redesignAll || chainSettings.highCutBypassed != chainDesignSettings.highCutBypassed
+        || highCutDesignChanged(chainSettings, chainDesignSettings)) {
+        monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+
+        auto highCutCoefficients = makeHighCutFilter(chainSettings, sampleRate);
+        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+        highCutResponseDirty = true;
+    }
+
+    chainDesignSettings = chainSettings;
+    chainSampleRate = sampleRate;
+    chainDesigned = true;
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
 {
     using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll(Colours::black);
+    auto paintStart = Time::getMillisecondCounterHiRes();
 
-    drawBackgroundGrid(g);
+    // (Opaque unless rendering with OpenGL, so we must completely fill the background with a solid colour)
+    if (!renderingWithOpenGL) {
+        g.fillAll(Colours::black);
+    }
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (background.isNull() || scale != backgroundScale) {
+        renderBackground(scale);
+    }
+
+    // In OpenGL mode the renderer has already drawn the background and the analyzer underneath.
+    if (!renderingWithOpenGL) {
+        g.drawImage(background, getLocalBounds().toFloat());
+    }
+
+    // Everything below moves every frame; keep it inside the border and its outline.
+    g.reduceClipRegion(getRenderArea().reduced(1));
 
     auto responseArea = getDrawArea();
 
-    if (showFFTAnalysis)
+    if (showFFTAnalysis && !renderingWithOpenGL)
     {
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        auto toResponseArea = AffineTransform::translation((float)responseArea.getX(), (float)responseArea.getY());
 
-        g.setColour(Colour(97u, 18u, 167u)); //purple-
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+        g.setColour(leftTraceColour); //purple-
+        g.strokePath(pathProducer.getPath(0), PathStrokeType(1.f), toResponseArea);
 
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-
-        g.setColour(Colour(215u, 201u, 134u));
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        g.setColour(rightTraceColour);
+        g.strokePath(pathProducer.getPath(1), PathStrokeType(1.f), toResponseArea);
     }
 
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));
 
+    updateFrameInterval(Time::getMillisecondCounterHiRes() - paintStart);
+}
+
+// Draws the grid, border mask, labels and outline at the given physical pixel scale. These only
+// change with the component's size or its display's scale, so paint() just blits the result.
+void ResponseCurveComponent::renderBackground(float scale) {
+    using namespace juce;
+    backgroundScale = scale;
+
+    auto width = jmax(1, roundToInt(getWidth() * scale));
+    auto height = jmax(1, roundToInt(getHeight() * scale));
+    background = Image(Image::RGB, width, height, true);
+
+    Graphics g(background);
+    g.addTransform(AffineTransform::scale(scale));
+
+    g.fillAll(Colours::black);
+    drawBackgroundGrid(g);
+
     Path border;
 
     border.setUsingNonZeroWinding(false);
@@ -317,6 +612,9 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
 
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    glRenderer.setBackground(background);
+#endif
 }
 
 std::vector<float> ResponseCurveComponent::getFrequencies()
@@ -338,35 +636,20 @@ std::vector<float> ResponseCurveComponent::getGains()
     };
 }
 
-std::vector<float> ResponseCurveComponent::getXs(const std::vector<float>& freqs, float left, float width)
-{
-    std::vector<float> xs;
-    for (auto f : freqs)
-    {
-        auto normX = juce::mapFromLog10(f, 20.f, 20000.f);
-        xs.push_back(left + width * normX);
-    }
-
-    return xs;
-}
-
 void ResponseCurveComponent::drawBackgroundGrid(juce::Graphics& g) {
     using namespace juce;
 
-    auto freqs = getFrequencies();
-
     auto renderArea = getDrawArea();
     auto left = renderArea.getX();
     auto right = renderArea.getRight();
     auto top = renderArea.getY();
     auto bottom = renderArea.getBottom();
-    auto width = renderArea.getWidth();
 
-    auto xs = getXs(freqs, left, width);
-
-    g.setColour(Colours::dimgrey);
-    for (auto f : xs) {
-        g.drawVerticalLine(f, top, bottom);
+    if (frequencyAxis != nullptr) {
+        g.setColour(Colours::dimgrey);
+        for (auto x : frequencyAxis->getGridXs()) {
+            g.drawVerticalLine(left + x, top, bottom);
+        }
     }
 
     auto gain = getGains();
@@ -379,22 +662,20 @@ void ResponseCurveComponent::drawBackgroundGrid(juce::Graphics& g) {
 
 void ResponseCurveComponent::drawTextLabels(juce::Graphics& g) {
     using namespace juce;
-    auto freqs = getFrequencies();
     auto renderArea = getDrawArea();
     auto left = renderArea.getX();
     auto right = renderArea.getRight();
     auto top = renderArea.getY();
     auto bottom = renderArea.getBottom();
-    auto width = renderArea.getWidth();
-    auto xs = getXs(freqs, left, width);
 
     g.setColour(Colours::lightgrey);
     const int fontHeight = 10;
     g.setFont(fontHeight);
-    
-    for (int i = 0; i < freqs.size(); ++i) {
-        auto f = freqs[i];
-        auto x = xs[i];
+
+    auto numGridLines = frequencyAxis != nullptr ? frequencyAxis->getGridFrequencies().size() : 0;
+    for (size_t i = 0; i < numGridLines; ++i) {
+        auto f = frequencyAxis->getGridFrequencies()[i];
+        auto x = left + frequencyAxis->getGridXs()[i];
 
         bool addK = false;
         String str;
@@ -442,74 +723,107 @@ void ResponseCurveComponent::resized() {
     using namespace juce;
     
     responseCurve.preallocateSpace(getWidth() * 3);
+    updateFrequencyAxis();
     updateResponseCurve();
+    updateGLLayout();
+
+    renderBackground(backgroundScale > 0.f ? backgroundScale : Component::getApproximateScaleFactorForComponent(this));
+}
+
+void ResponseCurveComponent::updateFrequencyAxis() {
+    auto w = getDrawArea().getWidth();
+    frequencyAxis = std::make_shared<const FrequencyAxis>(w, audioProcessor.getSampleRate(), getFrequencies());
+
+    auto size = (size_t)juce::jmax(0, w);
+    lowCutResponse.resize(size);
+    peakResponse.resize(size);
+    highCutResponse.resize(size);
+    totalResponse.resize(size);
+    lowCutResponseDirty = peakResponseDirty = highCutResponseDirty = true;
+}
+
+namespace {
+// Response in dB of the active stages of a cut filter at each frequency.
+void computeCutFilterResponse(const CutFilter& cut, const std::vector<double>& freqs, double sampleRate, std::vector<float>& response) {
+    for (size_t i = 0; i < freqs.size(); ++i) {
+        double mag = 1.0;
+        if (!cut.isBypassed<0>()) {
+            mag *= cut.get<0>().coefficients->getMagnitudeForFrequency(freqs[i], sampleRate);
+        }
+        if (!cut.isBypassed<1>()) {
+            mag *= cut.get<1>().coefficients->getMagnitudeForFrequency(freqs[i], sampleRate);
+        }
+        if (!cut.isBypassed<2>()) {
+            mag *= cut.get<2>().coefficients->getMagnitudeForFrequency(freqs[i], sampleRate);
+        }
+        if (!cut.isBypassed<3>()) {
+            mag *= cut.get<3>().coefficients->getMagnitudeForFrequency(freqs[i], sampleRate);
+        }
+        response[i] = (float)juce::Decibels::gainToDecibels(mag);
+    }
+}
 }
 
 void ResponseCurveComponent::updateResponseCurve(){
     using namespace juce;
     auto responseArea = getDrawArea();
     auto w = responseArea.getWidth();
+    if (frequencyAxis == nullptr || frequencyAxis->getWidth() != w || w <= 0) {
+        return;
+    }
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-
-    auto sampleRate = audioProcessor.getSampleRate();
-
-    std::vector<double> mags;
-
-    mags.resize(w);
+    auto& responseFrequencies = frequencyAxis->getColumnFrequencies();
+    auto sampleRate = chainSampleRate;
 
-    for (int i = 0; i < w; ++i) {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+    if (peakResponseDirty) {
+        if (monoChain.isBypassed<ChainPositions::Peak>()) {
+            FloatVectorOperations::clear(peakResponse.data(), w);
+        }
+        else {
+            auto& peak = monoChain.get<ChainPositions::Peak>();
+            for (int i = 0; i < w; ++i) {
+                auto mag = peak.coefficients->getMagnitudeForFrequency(responseFrequencies[i], sampleRate);
+                peakResponse[i] = (float)Decibels::gainToDecibels(mag);
+            }
+        }
+        peakResponseDirty = false;
+    }
 
-        if (!monoChain.isBypassed<ChainPositions::Peak>()) {
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (lowCutResponseDirty) {
+        if (monoChain.isBypassed<ChainPositions::LowCut>()) {
+            FloatVectorOperations::clear(lowCutResponse.data(), w);
+        }
+        else {
+            computeCutFilterResponse(monoChain.get<ChainPositions::LowCut>(), responseFrequencies, sampleRate, lowCutResponse);
         }
+        lowCutResponseDirty = false;
+    }
 
-        if (!monoChain.isBypassed<ChainPositions::LowCut>()) {
-            if (!lowcut.isBypassed<0>()) {
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lowcut.isBypassed<1>()) {
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lowcut.isBypassed<2>()) {
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!lowcut.isBypassed<3>()) {
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
+    if (highCutResponseDirty) {
+        if (monoChain.isBypassed<ChainPositions::HighCut>()) {
+            FloatVectorOperations::clear(highCutResponse.data(), w);
         }
-        if (!monoChain.isBypassed<ChainPositions::HighCut>()) {
-            if (!highcut.isBypassed<0>()) {
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!highcut.isBypassed<1>()) {
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!highcut.isBypassed<2>()) {
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
-            if (!highcut.isBypassed<3>()) {
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            }
+        else {
+            computeCutFilterResponse(monoChain.get<ChainPositions::HighCut>(), responseFrequencies, sampleRate, highCutResponse);
         }
-        mags[i] = Decibels::gainToDecibels(mag);
+        highCutResponseDirty = false;
     }
 
+    // Cascaded magnitudes multiply, so their decibels add.
+    FloatVectorOperations::add(totalResponse.data(), lowCutResponse.data(), peakResponse.data(), w);
+    FloatVectorOperations::add(totalResponse.data(), highCutResponse.data(), w);
+
     responseCurve.clear();
 
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input) {
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+    const float outputMin = (float)responseArea.getBottom();
+    const float outputMax = (float)responseArea.getY();
+    auto map = [outputMin, outputMax](float input) {
+        return jmap(input, -24.f, 24.f, outputMin, outputMax);
     };
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    responseCurve.startNewSubPath((float)responseArea.getX(), map(totalResponse.front()));
 
-    for (size_t i = 1; i < mags.size(); ++i) {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+    for (int i = 1; i < w; ++i) {
+        responseCurve.lineTo((float)(responseArea.getX() + i), map(totalResponse[i]));
     }
 
 }
@@ -554,7 +868,8 @@ SimpleEqAudioProcessorEditor::SimpleEqAudioProcessorEditor(SimpleEqAudioProcesso
     lowCutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypassed", lowCutBypassButton),
     peakBypassButtonAttachment(audioProcessor.apvts, "Peak Bypassed", peakBypassButton),
     highCutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypassed", highCutBypassButton),
-    analyzerBypassButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerBypassButton)
+    analyzerBypassButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerBypassButton),
+    diagnosticsOverlay(audioProcessor)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -585,10 +900,28 @@ SimpleEqAudioProcessorEditor::SimpleEqAudioProcessorEditor(SimpleEqAudioProcesso
         addAndMakeVisible(comp);
     }
 
-    peakBypassButton.setLookAndFeel(&lnf);
-    highCutBypassButton.setLookAndFeel(&lnf);
-    lowCutBypassButton.setLookAndFeel(&lnf);
-    analyzerBypassButton.setLookAndFeel(&lnf);
+    if (auto* resolutionParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Resolution"))) {
+        analyzerResolutionBox.addItemList(resolutionParam->choices, 1);
+    }
+    analyzerResolutionBoxAttachment = std::make_unique<ABVTS::ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Resolution", analyzerResolutionBox);
+
+    if (auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Analyzer Mode"))) {
+        analyzerModeBox.addItemList(modeParam->choices, 1);
+    }
+    analyzerModeBoxAttachment = std::make_unique<ABVTS::ComboBoxAttachment>(audioProcessor.apvts, "Analyzer Mode", analyzerModeBox);
+
+    analyzerOverlapBox.addItemList({ "Latest Only", "2x Overlap", "4x Overlap", "8x Overlap" }, 1);
+    attachToStateProperty(analyzerOverlapBox, StateProperties::analyzerOverlap, StateProperties::analyzerOverlapDefault);
+
+    for (auto framesPerSecond : StateProperties::analyzerFrameRates) {
+        frameRateBox.addItem(juce::String(framesPerSecond) + " fps", frameRateBox.getNumItems() + 1);
+    }
+    attachToStateProperty(frameRateBox, StateProperties::analyzerFrameRate, StateProperties::analyzerFrameRateDefault);
+
+    peakBypassButton.setLookAndFeel(&lnf.get());
+    highCutBypassButton.setLookAndFeel(&lnf.get());
+    lowCutBypassButton.setLookAndFeel(&lnf.get());
+    analyzerBypassButton.setLookAndFeel(&lnf.get());
 
     auto safePtr = juce::Component::SafePointer<SimpleEqAudioProcessorEditor>(this);
     peakBypassButton.onClick = [safePtr]() {
@@ -621,11 +954,32 @@ SimpleEqAudioProcessorEditor::SimpleEqAudioProcessorEditor(SimpleEqAudioProcesso
         }
     };
 
+    attachToStateProperty(openGLButton, StateProperties::openGLRendering, StateProperties::openGLRenderingDefault, [safePtr](bool isOn) {
+        if (auto* comp = safePtr.getComponent()) {
+            comp->setOpenGLEnabled(isOn);
+        }
+    });
+
+    addChildComponent(diagnosticsOverlay);
+    setWantsKeyboardFocus(true);
+
+    audioProcessor.apvts.state.addListener(this);
+
+#if !JUCE_MODULE_AVAILABLE_juce_opengl
+    openGLButton.setVisible(false);
+#endif
+
     setSize (600, 480);
+
+    setOpenGLEnabled(openGLButton.getToggleState());
 }
 
 SimpleEqAudioProcessorEditor::~SimpleEqAudioProcessorEditor()
 {
+    audioProcessor.apvts.state.removeListener(this);
+    cancelPendingUpdate();
+    setOpenGLEnabled(false);
+
     peakBypassButton.setLookAndFeel(nullptr);
     highCutBypassButton.setLookAndFeel(nullptr);
     lowCutBypassButton.setLookAndFeel(nullptr);
@@ -633,9 +987,33 @@ SimpleEqAudioProcessorEditor::~SimpleEqAudioProcessorEditor()
 }
 
 //==============================================================================
+void SimpleEqAudioProcessorEditor::setOpenGLEnabled(bool shouldBeEnabled)
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    if (shouldBeEnabled) {
+        if (!openGLContext.isAttached()) {
+            openGLContext.setRenderer(&responseCurveComponent.getGLRenderer());
+            openGLContext.attachTo(*this);
+        }
+        responseCurveComponent.setOpenGLRequested(true);
+    }
+    else {
+        responseCurveComponent.setOpenGLRequested(false);
+        openGLContext.detach();
+    }
+#else
+    juce::ignoreUnused(shouldBeEnabled);
+#endif
+}
+
 void SimpleEqAudioProcessorEditor::paint (juce::Graphics& g)
 {
     using namespace juce;
+    // The response curve's OpenGL layer shows through a hole in the component layer.
+    if (responseCurveComponent.isRenderingWithOpenGL()) {
+        g.excludeClipRegion(responseCurveComponent.getBounds());
+    }
+
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll(Colours::black);
 
@@ -655,6 +1033,11 @@ void SimpleEqAudioProcessorEditor::resized()
     analyzerEnabledArea.removeFromTop(2);
 
     analyzerBypassButton.setBounds(analyzerEnabledArea);
+    analyzerResolutionBox.setBounds(analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 5).withWidth(80));
+    analyzerModeBox.setBounds(analyzerResolutionBox.getBounds().withX(analyzerResolutionBox.getRight() + 5).withWidth(90));
+    analyzerOverlapBox.setBounds(analyzerModeBox.getBounds().withX(analyzerModeBox.getRight() + 5).withWidth(100));
+    frameRateBox.setBounds(analyzerOverlapBox.getBounds().withX(analyzerOverlapBox.getRight() + 5).withWidth(80));
+    openGLButton.setBounds(frameRateBox.getBounds().withX(frameRateBox.getRight() + 5).withWidth(80));
     bounds.removeFromTop(5);
 
     float hRatio = 25 / 100.f;
@@ -677,6 +1060,113 @@ void SimpleEqAudioProcessorEditor::resized()
     peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
     peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
     peakQualitySlider.setBounds(bounds);
+
+    diagnosticsOverlay.setBounds(getLocalBounds().reduced(20).withHeight(200));
+}
+
+void SimpleEqAudioProcessorEditor::attachToStateProperty(juce::ComboBox& box, const juce::Identifier& property, int defaultIndex) {
+    auto& state = audioProcessor.apvts.state;
+    auto sync = [&box, &state, property, defaultIndex] {
+        box.setSelectedItemIndex(juce::jlimit(0, box.getNumItems() - 1, (int)state.getProperty(property, defaultIndex)), juce::dontSendNotification);
+    };
+    sync();
+    controlSyncs.push_back(sync);
+    box.onChange = [&box, &state, property] {
+        state.setProperty(property, box.getSelectedItemIndex(), nullptr);
+    };
+}
+
+void SimpleEqAudioProcessorEditor::attachToStateProperty(juce::Button& button, const juce::Identifier& property, bool defaultState,
+                                                         std::function<void(bool)> onToggle) {
+    auto& state = audioProcessor.apvts.state;
+    button.setToggleState((bool)state.getProperty(property, defaultState), juce::dontSendNotification);
+    // Later syncs click the button, so onToggle sees loaded state as well as the user's clicks.
+    controlSyncs.push_back([&button, &state, property, defaultState] {
+        button.setToggleState((bool)state.getProperty(property, defaultState), juce::sendNotificationSync);
+    });
+    button.onClick = [&button, &state, property, onToggle = std::move(onToggle)] {
+        state.setProperty(property, button.getToggleState(), nullptr);
+        onToggle(button.getToggleState());
+    };
+}
+
+void SimpleEqAudioProcessorEditor::handleAsyncUpdate() {
+    for (auto& sync : controlSyncs) {
+        sync();
+    }
+}
+
+bool SimpleEqAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    if (key == juce::KeyPress('d', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0)) {
+        diagnosticsOverlay.setVisible(!diagnosticsOverlay.isVisible());
+        return true;
+    }
+    return false;
+}
+
+void DiagnosticsOverlay::paint(juce::Graphics& g)
+{
+    using namespace juce;
+    g.fillAll(Colours::black.withAlpha(0.85f));
+    g.setColour(Colours::lightgrey);
+    g.drawRect(getLocalBounds());
+
+    auto timing = audioProcessor.getProcessTimingSnapshot();
+    auto bounds = getLocalBounds().reduced(8);
+    const int lineHeight = 16;
+    g.setFont(12);
+
+    String line;
+    line << "Blocks: " << (int)timing.numBlocks << "   Over budget: " << (int)timing.numOverruns
+         << "   Max load: " << String(timing.maxLoad * 100.f, 1) << "%";
+    g.drawFittedText(line, bounds.removeFromTop(lineHeight), Justification::centredLeft, 1);
+
+    line.clear();
+    line << "Redesigns   low cut: " << audioProcessor.getRedesignCount(ChainPositions::LowCut)
+         << "   peak: " << audioProcessor.getRedesignCount(ChainPositions::Peak)
+         << "   high cut: " << audioProcessor.getRedesignCount(ChainPositions::HighCut);
+    g.drawFittedText(line, bounds.removeFromTop(lineHeight), Justification::centredLeft, 1);
+
+    line.clear();
+    line << "Cache hits  low cut: " << audioProcessor.getCacheHitCount(ChainPositions::LowCut)
+         << "   peak: " << audioProcessor.getCacheHitCount(ChainPositions::Peak)
+         << "   high cut: " << audioProcessor.getCacheHitCount(ChainPositions::HighCut);
+    g.drawFittedText(line, bounds.removeFromTop(lineHeight), Justification::centredLeft, 1);
+
+    line.clear();
+    if (AudioThreadGuard::isEnabled()) {
+        line << "Audio thread allocations: " << AudioThreadGuard::getAllocationCount()
+             << "   locks: " << AudioThreadGuard::getLockCount()
+             << "   pool waits: " << AudioThreadGuard::getWaitCount();
+    }
+    else {
+        line << "Audio thread guard is off in this build";
+    }
+    g.drawFittedText(line, bounds.removeFromTop(lineHeight), Justification::centredLeft, 1);
+
+    // One bar per bucket of processBlock time as a share of the block's duration.
+    bounds.removeFromTop(6);
+    auto labelArea = bounds.removeFromBottom(lineHeight);
+    juce::uint32 maxCount = 1;
+    for (auto count : timing.counts) {
+        maxCount = jmax(maxCount, count);
+    }
+
+    auto barWidth = bounds.getWidth() / (int)ProcessTimingHistogram::numBuckets;
+    for (size_t i = 0; i < ProcessTimingHistogram::numBuckets; ++i) {
+        auto barArea = bounds.withX(bounds.getX() + (int)i * barWidth).withWidth(barWidth).reduced(2, 0);
+        auto height = roundToInt(barArea.getHeight() * (float)timing.counts[i] / (float)maxCount);
+        auto overBudget = i >= ProcessTimingHistogram::bucketLimits.size() || ProcessTimingHistogram::bucketLimits[i] > 1.f;
+        g.setColour(overBudget ? Colours::red : Colours::skyblue);
+        g.fillRect(barArea.removeFromBottom(height));
+
+        auto label = i < ProcessTimingHistogram::bucketLimits.size()
+            ? String(roundToInt(ProcessTimingHistogram::bucketLimits[i] * 100.f))
+            : String(">");
+        g.setColour(Colours::lightgrey);
+        g.drawFittedText(label, labelArea.withX(barArea.getX()).withWidth(barArea.getWidth()), Justification::centred, 1);
+    }
 }
 
 
@@ -694,6 +1184,11 @@ std::vector<juce::Component*> SimpleEqAudioProcessorEditor::getComps() {
         &lowCutBypassButton,
         &peakBypassButton,
         &highCutBypassButton,
-        &analyzerBypassButton
+        &analyzerBypassButton,
+        &analyzerResolutionBox,
+        &analyzerModeBox,
+        &analyzerOverlapBox,
+        &frameRateBox,
+        &openGLButton
     };
 }
@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "AnalyzerGLRenderer.h"
 
 enum FFTOrder {
     order2048 = 11,
@@ -17,68 +18,299 @@ enum FFTOrder {
     order8192 = 13
 };
 
+// FFT plans and windows for every FFTOrder, built once and shared by every analyzer in the process.
+// Only ever used from the analyzer thread.
+struct FFTEngines {
+    static constexpr int numOrders = FFTOrder::order8192 - FFTOrder::order2048 + 1;
+    static constexpr int maxFFTSize = 1 << FFTOrder::order8192;
+
+    FFTEngines() {
+        for (int i = 0; i < numOrders; ++i) {
+            auto order = FFTOrder::order2048 + i;
+            ffts[(size_t)i] = std::make_unique<juce::dsp::FFT>(order);
+            windows[(size_t)i] = std::make_unique<juce::dsp::WindowingFunction<float>>(1 << order, juce::dsp::WindowingFunction<float>::blackmanHarris);
+
+            // The same (normalised) window as a table, for callers that window something other
+            // than a single real block.
+            auto& table = windowTables[(size_t)i];
+            table.resize((size_t)1 << order);
+            juce::dsp::WindowingFunction<float>::fillWindowingTables(table.data(), table.size(), juce::dsp::WindowingFunction<float>::blackmanHarris, true);
+        }
+    }
+
+    juce::dsp::FFT& getFFT(FFTOrder order) { return *ffts[(size_t)(order - FFTOrder::order2048)]; }
+    juce::dsp::WindowingFunction<float>& getWindow(FFTOrder order) { return *windows[(size_t)(order - FFTOrder::order2048)]; }
+    const float* getWindowTable(FFTOrder order) const { return windowTables[(size_t)(order - FFTOrder::order2048)].data(); }
+
+private:
+    std::array<std::unique_ptr<juce::dsp::FFT>, numOrders> ffts;
+    std::array<std::unique_ptr<juce::dsp::WindowingFunction<float>>, numOrders> windows;
+    std::array<std::vector<float>, numOrders> windowTables;
+};
+
+// Log-frequency mapping between 20 Hz - 20 kHz and the pixel columns of the analyzer's draw area.
+// Rebuilt only when the width or sample rate changes; once built it is immutable, so the analyzer
+// thread can share it with the message thread.
+struct FrequencyAxis {
+    FrequencyAxis(int width, double sampleRate, const std::vector<float>& gridFrequencies) :
+        width(width), sampleRate(sampleRate), gridFrequencies(gridFrequencies)
+    {
+        columnFrequencies.resize((size_t)juce::jmax(0, width));
+        for (int i = 0; i < width; ++i) {
+            columnFrequencies[(size_t)i] = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+        }
+
+        for (int i = 0; i < FFTEngines::numOrders; ++i) {
+            auto fftSize = 1 << (FFTOrder::order2048 + i);
+            auto binWidth = float(sampleRate / double(fftSize));
+            auto& columns = binPositions[(size_t)i];
+            columns.resize((size_t)fftSize / 2);
+
+            // Bin 0 (DC) has no place on a log axis; paths start from the left edge.
+            columns[0] = 0.f;
+            for (size_t binNum = 1; binNum < columns.size(); ++binNum) {
+                auto normalizedBinX = juce::mapFromLog10(binNum * binWidth, 20.f, 20000.f);
+                columns[binNum] = normalizedBinX * float(width);
+            }
+        }
+
+        for (auto f : gridFrequencies) {
+            gridXs.push_back(float(width) * juce::mapFromLog10(f, 20.f, 20000.f));
+        }
+    }
+
+    int getWidth() const { return width; }
+    double getSampleRate() const { return sampleRate; }
+
+    // Frequency at each pixel column.
+    const std::vector<double>& getColumnFrequencies() const { return columnFrequencies; }
+    // Unrounded x position of each FFT bin for the given order, relative to the left edge.
+    // Increases with the bin number.
+    const std::vector<float>& getBinPositions(FFTOrder order) const { return binPositions[(size_t)(order - FFTOrder::order2048)]; }
+    // The grid lines' frequencies and their x positions, relative to the left edge.
+    const std::vector<float>& getGridFrequencies() const { return gridFrequencies; }
+    const std::vector<float>& getGridXs() const { return gridXs; }
+
+private:
+    int width;
+    double sampleRate;
+    std::vector<double> columnFrequencies;
+    std::array<std::vector<float>, FFTEngines::numOrders> binPositions;
+    std::vector<float> gridFrequencies, gridXs;
+};
+
+// Normalizes, sanitizes and converts FFT magnitudes to decibels in place, in a single branch-free
+// pass the compiler can vectorize. Non-finite bins are treated as silence, and log10 is replaced by
+// an exponent/mantissa split with a polynomial for log2 of the mantissa, which is accurate to about a
+// thousandth of a dB - far below what the analyzer can show.
+inline void magnitudesToDecibels(float* data, int numBins, float normalisation, float negativeInfinity) {
+    constexpr float decibelsPerOctave = 6.0205999f; // 20 * log10(2)
+
+    for (int i = 0; i < numBins; ++i) {
+        juce::uint32 bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+        auto isFinite = (bits & 0x7f800000u) != 0x7f800000u;
+        auto gain = isFinite ? data[i] * normalisation : 0.f;
+
+        std::memcpy(&bits, &gain, sizeof(bits));
+        auto exponent = (float)((int)((bits >> 23) & 0xffu) - 127);
+        auto mantissaBits = (bits & 0x007fffffu) | 0x3f800000u;
+        float mantissa;
+        std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+
+        auto log2Mantissa = -2.4968058f + (4.0284505f + (-2.0811285f + (0.62884137f - 0.079153816f * mantissa) * mantissa) * mantissa) * mantissa;
+        auto decibels = decibelsPerOctave * (exponent + log2Mantissa);
+
+        data[i] = gain > 0.f ? juce::jmax(decibels, negativeInfinity) : negativeInfinity;
+    }
+}
+
+// The newest samples of one analyzer channel, kept in a circular buffer. Appending costs what the
+// incoming block costs, whatever the capacity; readers get the newest samples as at most two
+// contiguous spans, split where the buffer wraps.
+struct AnalyzerHistory {
+    void prepare(int capacity) {
+        samples.assign((size_t)capacity, 0.f);
+        writePosition = 0;
+    }
+
+    int getCapacity() const { return (int)samples.size(); }
+    const float* getData() const { return samples.data(); }
+
+    void append(const float* data, int numSamples) {
+        const auto capacity = getCapacity();
+        // Of a block longer than the history only the tail would survive.
+        if (numSamples > capacity) {
+            data += numSamples - capacity;
+            numSamples = capacity;
+        }
+        auto first = juce::jmin(numSamples, capacity - writePosition);
+        juce::FloatVectorOperations::copy(samples.data() + writePosition, data, first);
+        juce::FloatVectorOperations::copy(samples.data(), data + first, numSamples - first);
+        writePosition = (writePosition + numSamples) % capacity;
+    }
+
+    // Index of the oldest of the newest numSamples samples; numSamples must not exceed the capacity.
+    int getStartOfLatest(int numSamples) const {
+        jassert(numSamples <= getCapacity());
+        return (writePosition - numSamples + getCapacity()) % getCapacity();
+    }
+
+private:
+    std::vector<float> samples;
+    int writePosition = 0;
+};
+
 template<typename BlockType>
 struct FFTDataGenerator {
+    FFTDataGenerator() {
+        // Sized for the largest order up front, so changing order never reallocates.
+        prepareFFTData(fftData);
+        fftDataFifo.prepare(fftData.size());
+    }
+
+    // Analyzes the most recent getFFTSize() samples of audioData.
     void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity) {
         const auto fftSize = getFFTSize();
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
+        auto* readIndex = audioData.getReadPointer(0, audioData.getNumSamples() - fftSize);
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
-        int numBins = (int)fftSize / 2;
-        for (int i = 0; i < numBins; ++i) {
-            auto v = fftData[i];
-            if (!std::isinf(v) && !std::isnan(v)) {
-                v /= float(numBins);
-            }
-            else {
-                v = 0.f;
-            }
-            fftData[i] = v;
-        }
+        transformFFTData(negativeInfinity);
+    }
 
-        for (int i = 0; i < numBins; ++i) {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
-        fftDataFifo.push(fftData);
+    // Analyzes the most recent getFFTSize() samples of history, unwrapping it on the way in.
+    void produceFFTDataForRendering(const AnalyzerHistory& history, const float negativeInfinity) {
+        const auto fftSize = getFFTSize();
+        const auto capacity = history.getCapacity();
+        const auto start = history.getStartOfLatest(fftSize);
+        const auto first = juce::jmin(fftSize, capacity - start);
+        juce::FloatVectorOperations::copy(fftData.data(), history.getData() + start, first);
+        juce::FloatVectorOperations::copy(fftData.data() + first, history.getData(), fftSize - first);
+        transformFFTData(negativeInfinity);
+    }
+
+private:
+    // Windows, transforms and publishes the block in the first getFFTSize() entries of fftData.
+    void transformFFTData(const float negativeInfinity) {
+        const auto fftSize = getFFTSize();
+        std::fill(fftData.begin() + fftSize, fftData.begin() + fftSize * 2, 0.f);
+        engines->getWindow(order).multiplyWithWindowingTable(fftData.data(), fftSize);
+        engines->getFFT(order).performFrequencyOnlyForwardTransform(fftData.data());
+        int numBins = (int)fftSize / 2;
+        magnitudesToDecibels(fftData.data(), numBins, 1.f / float(numBins), negativeInfinity);
+        fftDataFifo.pushBySwap(fftData);
     }
 
+public:
+    // Switching order only selects a different prebuilt engine. Spectra of the old order that
+    // haven't been picked up yet are dropped, so must be called from the FIFO's reading thread.
     void changeOrder(FFTOrder newOrder) {
         order = newOrder;
-        auto fftSize = getFFTSize();
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-        fftDataFifo.prepare(fftData.size());
+        fftDataFifo.discard(fftDataFifo.getNumAvailableForReading());
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
+    FFTOrder getOrder() const { return order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
 
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    // fftData must have been sized with prepareFFTData(); it is exchanged with the FIFO's slot.
+    bool getFFTData(BlockType& fftData) { return fftDataFifo.pullBySwap(fftData); }
+    static void prepareFFTData(BlockType& fftData) { fftData.assign(FFTEngines::maxFFTSize * 2, 0.f); }
     //==============================================================================
 private:
-    FFTOrder order;
+    FFTOrder order = FFTOrder::order2048;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT>forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    juce::SharedResourcePointer<FFTEngines> engines;
+
+    // Every spectrum is pulled as soon as it has been produced, so a few slots are plenty; each
+    // one still holds the largest order, so that changing order never reallocates.
+    static constexpr int fftDataFifoCapacity = 4;
+    Fifo<BlockType, fftDataFifoCapacity> fftDataFifo;
+};
+
+// Analyzes two real channels with a single complex FFT: the windowed channels go in as the real and
+// imaginary parts of one signal, and each channel's spectrum is separated out of the result using
+// the FFT's conjugate symmetry. One window pass and one transform instead of two of each.
+struct PackedStereoFFT {
+    PackedStereoFFT() {
+        input.resize(FFTEngines::maxFFTSize);
+        output.resize(FFTEngines::maxFFTSize);
+    }
+
+    // Reads the newest fftSize samples of a and b and writes their magnitude spectra in dB to the
+    // first fftSize / 2 entries of aOut and bOut. With midSide set, (a + b) / 2 and (a - b) / 2 are
+    // analyzed instead.
+    void perform(FFTOrder order, const AnalyzerHistory& a, const AnalyzerHistory& b, bool midSide, std::vector<float>& aOut, std::vector<float>& bOut, float negativeInfinity) {
+        const auto fftSize = 1 << order;
+        const auto* window = engines->getWindowTable(order);
+
+        // Window straight out of both histories, in runs that stop wherever either one wraps.
+        auto indexA = a.getStartOfLatest(fftSize);
+        auto indexB = b.getStartOfLatest(fftSize);
+        for (int n = 0; n < fftSize;) {
+            auto length = juce::jmin(fftSize - n, a.getCapacity() - indexA, b.getCapacity() - indexB);
+            windowInto(input.data() + n, a.getData() + indexA, b.getData() + indexB, window + n, length, midSide);
+            n += length;
+            indexA = (indexA + length) % a.getCapacity();
+            indexB = (indexB + length) % b.getCapacity();
+        }
+
+        engines->getFFT(order).perform(input.data(), output.data(), false);
+
+        // With Z = FFT(a + ib): A[k] = (Z[k] + conj(Z[N - k])) / 2 and B[k] = (Z[k] - conj(Z[N - k])) / 2i.
+        const int numBins = fftSize / 2;
+        for (int k = 0; k < numBins; ++k) {
+            auto z = output[(size_t)k];
+            auto mirror = output[(size_t)((fftSize - k) & (fftSize - 1))];
+            auto aRe = z.real() + mirror.real(), aIm = z.imag() - mirror.imag();
+            auto bRe = z.real() - mirror.real(), bIm = z.imag() + mirror.imag();
+            aOut[(size_t)k] = 0.5f * std::sqrt(aRe * aRe + aIm * aIm);
+            bOut[(size_t)k] = 0.5f * std::sqrt(bRe * bRe + bIm * bIm);
+        }
 
-    Fifo<BlockType> fftDataFifo;
+        magnitudesToDecibels(aOut.data(), numBins, 1.f / float(numBins), negativeInfinity);
+        magnitudesToDecibels(bOut.data(), numBins, 1.f / float(numBins), negativeInfinity);
+    }
+
+private:
+    static void windowInto(juce::dsp::Complex<float>* dest, const float* a, const float* b, const float* window, int length, bool midSide) {
+        if (midSide) {
+            for (int n = 0; n < length; ++n) {
+                auto w = 0.5f * window[n];
+                dest[n] = { (a[n] + b[n]) * w, (a[n] - b[n]) * w };
+            }
+        }
+        else {
+            for (int n = 0; n < length; ++n) {
+                dest[n] = { a[n] * window[n], b[n] * window[n] };
+            }
+        }
+    }
+
+    juce::SharedResourcePointer<FFTEngines> engines;
+    std::vector<juce::dsp::Complex<float>> input, output;
+};
+
+enum PathDecimation {
+    binStride,      // a vertex for every other bin, whatever column it lands on
+    peakPerColumn   // at most a min/max pair per pixel column; sparse bins keep their exact x
 };
 
 template<typename PathType>
 struct AnalyzerPathGenerator {
-    void generatePath(const std::vector<float>& renderData, juce::Rectangle<float> fftBounds, int fftSize, float binWidth, float negativeInfinity) {
+    // May be called from any thread; used from the next generatePath().
+    void setDecimation(PathDecimation newDecimation) { decimation = newDecimation; }
+
+    void generatePath(const std::vector<float>& renderData, juce::Rectangle<float> fftBounds, FFTOrder order, const FrequencyAxis& axis, float negativeInfinity) {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
 
-        int numBins = (int)fftSize / 2;
+        auto& binPositions = axis.getBinPositions(order);
+        int numBins = (int)binPositions.size();
 
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        // Reused between calls and exchanged with the FIFO, so its storage is recycled.
+        auto& p = pathToFill;
+        p.clear();
+        p.preallocateSpace(3 * (2 * (int)fftBounds.getWidth() + 2));
         auto map = [bottom, top, negativeInfinity](float v) {
             return juce::jmap(v, negativeInfinity, 0.f, float(bottom + 10), top);
         };
@@ -89,19 +321,21 @@ struct AnalyzerPathGenerator {
         }  
         p.startNewSubPath(0, y);
 
-        const int pathResolution = 2;
+        if (decimation.load() == PathDecimation::peakPerColumn) {
+            addPeakPerColumn(p, renderData, binPositions, fftBounds.getWidth(), map);
+        }
+        else {
+            const int pathResolution = 2;
 
-        for (int binNum = 1; binNum < numBins; binNum += pathResolution) {
-            y = map(renderData[binNum]);
+            for (int binNum = 1; binNum < numBins; binNum += pathResolution) {
+                y = map(renderData[binNum]);
 
-            if (!std::isnan(y) && !std::isinf(y)) {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                if (!std::isnan(y) && !std::isinf(y)) {
+                    p.lineTo(std::floor(binPositions[(size_t)binNum]), y);
+                }
             }
         }
-        pathFifo.push(p);
+        pathFifo.pushBySwap(p);
     }
 
     int getNumPathsAvailable() const {
@@ -109,11 +343,68 @@ struct AnalyzerPathGenerator {
     }
 
     bool getPath(PathType& path) {
-        return pathFifo.pull(path);
+        return pathFifo.pullBySwap(path);
     }
 
 private:
+    // Bins that share a pixel column collapse to their lowest and highest points, in the order
+    // they occur, so the path stays continuous. A bin alone in its column is placed at its exact x,
+    // so the sparse low end is drawn as straight segments between the true bin positions.
+    template<typename MapType>
+    static void addPeakPerColumn(PathType& p, const std::vector<float>& renderData, const std::vector<float>& binPositions, float width, MapType map) {
+        int column = -1;
+        int count = 0;
+        float firstX = 0.f, minY = 0.f, maxY = 0.f;
+        bool minFirst = true;
+
+        auto flush = [&]() {
+            if (count == 1) {
+                p.lineTo(firstX, minY);
+            }
+            else if (count > 1) {
+                auto x = float(column);
+                p.lineTo(x, minFirst ? minY : maxY);
+                p.lineTo(x, minFirst ? maxY : minY);
+            }
+        };
+
+        for (size_t binNum = 1; binNum < binPositions.size(); ++binNum) {
+            auto x = binPositions[binNum];
+            if (x >= width) {
+                break;
+            }
+            auto y = map(renderData[binNum]);
+            if (x < 0.f || std::isnan(y) || std::isinf(y)) {
+                continue;
+            }
+
+            auto binColumn = (int)x;
+            if (binColumn != column) {
+                flush();
+                column = binColumn;
+                count = 1;
+                firstX = x;
+                minY = maxY = y;
+                minFirst = true;
+                continue;
+            }
+
+            ++count;
+            if (y < minY) {
+                minY = y;
+                minFirst = false;
+            }
+            else if (y > maxY) {
+                maxY = y;
+                minFirst = true;
+            }
+        }
+        flush();
+    }
+
     Fifo<PathType> pathFifo;
+    PathType pathToFill;
+    std::atomic<PathDecimation> decimation{ PathDecimation::peakPerColumn };
 
 };
 
@@ -122,11 +413,33 @@ struct LookAndFeel : juce::LookAndFeel_V4 {
     void drawRotarySlider(juce::Graphics&, int x, int y, int width, int height, float sliderPosProportional, float rotaryStartAngle, float rotaryEndAngle, juce::Slider&) override;
 
     void drawToggleButton(juce::Graphics&, juce::ToggleButton& toggleButton, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDrawn) override;
+
+private:
+    // Glyph paths are only built the first time a component of a given size is drawn. One instance
+    // is shared by every slider and button in every editor, so the caches only ever hold a few
+    // entries; they are used from the message thread only.
+    const juce::Path& getPointerPath(juce::Rectangle<float> sliderBounds, float textHeight);
+    const juce::Path& getPowerSymbolPath(juce::Rectangle<int> buttonBounds);
+
+    struct PointerPath {
+        juce::Rectangle<float> bounds;
+        float textHeight;
+        juce::Path path;
+    };
+
+    struct PowerSymbolPath {
+        juce::Rectangle<int> bounds;
+        juce::Path path;
+    };
+
+    static constexpr size_t maxCachedPaths = 16;
+    std::vector<PointerPath> pointerPaths;
+    std::vector<PowerSymbolPath> powerSymbolPaths;
 };
 
 struct RotarySliderWithLabels : juce::Slider {
     RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix) : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag, juce::Slider::NoTextBox), param(&rap), suffix(unitSuffix) {
-        setLookAndFeel(&lnf);
+        setLookAndFeel(&lnf.get());
     }
 
     ~RotarySliderWithLabels() {
@@ -145,32 +458,144 @@ struct RotarySliderWithLabels : juce::Slider {
     int getTextHeight() const { return 14; }
     juce::String getDisplayString() const;
 private:
-    LookAndFeel lnf;
+    juce::SharedResourcePointer<LookAndFeel> lnf;
 
     juce::RangedAudioParameter* param;
     juce::String suffix;
 };
 
-struct PathProducer
+//==============================================================================
+// One thread shared by every open editor that runs the analyzer's FFT and path generation, so the
+// message thread only has to pick up finished paths and paint them.
+struct AnalyzerThread : juce::Thread {
+    struct Client {
+        virtual ~Client() = default;
+        virtual void process() = 0;
+    };
+
+    AnalyzerThread() : juce::Thread("SimpleEq Analyzer") {
+        startThread();
+    }
+
+    ~AnalyzerThread() override {
+        stopThread(1000);
+    }
+
+    void addClient(Client* client) {
+        const juce::ScopedLock sl(clientLock);
+        clients.addIfNotAlreadyThere(client);
+    }
+
+    void removeClient(Client* client) {
+        const juce::ScopedLock sl(clientLock);
+        clients.removeFirstMatchingValue(client);
+    }
+
+    void run() override {
+        while (!threadShouldExit()) {
+            {
+                const juce::ScopedLock sl(clientLock);
+                for (auto* client : clients) {
+                    client->process();
+                }
+            }
+            wait(intervalMs);
+        }
+    }
+
+private:
+    static constexpr int intervalMs = 1000 / 60;
+    juce::CriticalSection clientLock;
+    juce::Array<Client*> clients;
+};
+
+enum AnalyzerChannelMode {
+    packedStereo,       // left and right through one complex FFT
+    packedMidSide       // mid and side through one complex FFT
+};
+
+// Turns the processor's two analyzer FIFOs into one path per channel (or for mid and side).
+struct PathProducer : AnalyzerThread::Client
 {
-    PathProducer(SingleChannelSampleFifo<SimpleEqAudioProcessor::BlockType>& scsf) :
-        leftChannelFifo(&scsf)
+    static constexpr int numChannels = 2;
+
+    PathProducer(SingleChannelSampleFifo<SimpleEqAudioProcessor::BlockType>& left, SingleChannelSampleFifo<SimpleEqAudioProcessor::BlockType>& right) :
+        channelFifos{ &left, &right }
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        for (int ch = 0; ch < numChannels; ++ch) {
+            histories[(size_t)ch].prepare(FFTEngines::maxFFTSize);
+            FFTDataGenerator<std::vector<float>>::prepareFFTData(fftData[(size_t)ch]);
+            FFTDataGenerator<std::vector<float>>::prepareFFTData(frameSpectra[(size_t)ch]);
+        }
+        analyzerThread->addClient(this);
+    }
+
+    ~PathProducer() override {
+        analyzerThread->removeClient(this);
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath; }
+
+    // Called on the message thread whenever the analyzer's bounds or frequency axis change.
+    void setRenderParameters(juce::Rectangle<float> fftBounds, std::shared_ptr<const FrequencyAxis> axis);
+
+    // With latestOnly set, at most one FFT runs per analyzer frame, on the newest samples, and
+    // buffers that the window would no longer reach are skipped. Otherwise an FFT runs every
+    // fftSize / overlap new samples and each frame's path holds the peak of every spectrum since
+    // the previous one, so short transients between frames still show.
+    void setAnalysisMode(bool latestOnly, int overlap) {
+        analyzeLatestOnly = latestOnly;
+        overlapFactor = juce::jmax(1, overlap);
+    }
+
+    // Takes effect on the analyzer thread's next pass.
+    void setFFTOrder(FFTOrder order) { requestedOrder = order; }
+    void setChannelMode(AnalyzerChannelMode mode) { channelMode = mode; }
+    // API only: the editor keeps the default peakPerColumn, and nothing in the UI selects binStride.
+    // It is left in for embedding code and A/B comparisons like the path generation benchmark.
+    void setPathDecimation(PathDecimation decimation) {
+        for (auto& generator : pathGenerators) {
+            generator.setDecimation(decimation);
+        }
+    }
+
+    // Called on the analyzer thread.
+    void process() override;
+
+    // Called on the message thread; returns true if a new path arrived since the last call.
+    bool pullLatestPaths();
+    // Left and right, or mid and side.
+    const juce::Path& getPath(int channel) const { return paths[(size_t)channel]; }
 private:
-    SingleChannelSampleFifo<SimpleEqAudioProcessor::BlockType>* leftChannelFifo;
+    // Leaves the newest spectrum of each channel's history in fftData.
+    void produceSpectra(AnalyzerChannelMode mode);
+    // Folds fftData into frameSpectra, starting the frame over when isFirstInFrame is set.
+    void accumulateSpectra(bool isFirstInFrame);
+
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    juce::SpinLock renderParametersLock;
+    juce::Rectangle<float> renderBounds;
+    std::shared_ptr<const FrequencyAxis> renderAxis;
 
-    juce::AudioBuffer<float> monoBuffer;
+    std::atomic<FFTOrder> requestedOrder{ FFTOrder::order2048 };
+    std::atomic<AnalyzerChannelMode> channelMode{ AnalyzerChannelMode::packedStereo };
+    std::atomic<bool> analyzeLatestOnly{ true };
+    std::atomic<int> overlapFactor{ 4 };
+    FFTOrder currentOrder = FFTOrder::order2048;
+    int samplesSinceLastFFT = 0;
 
-    FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    std::array<SingleChannelSampleFifo<SimpleEqAudioProcessor::BlockType>*, numChannels> channelFifos;
 
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    std::array<AnalyzerHistory, numChannels> histories;
 
-    juce::Path leftChannelFFTPath;
+    // Kept between passes so that steady-state frames reuse their storage.
+    juce::AudioBuffer<float> incomingBuffer;
+    std::array<std::vector<float>, numChannels> fftData, frameSpectra;
+
+    PackedStereoFFT packedFFT;
+
+    std::array<AnalyzerPathGenerator<juce::Path>, numChannels> pathGenerators;
+
+    std::array<juce::Path, numChannels> paths;
 };
 
 struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer {
@@ -182,17 +607,69 @@ struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::
     void timerCallback() override;
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void toggleAnalysisEnablement(bool enabled) {
-        showFFTAnalysis = enabled;
-    }
+    void toggleAnalysisEnablement(bool enabled);
+
+    // Upper bound for the repaint rate. The actual rate drops below it while nothing changes, or
+    // while painting can't keep up. Follows the AnalyzerFrameRate state property.
+    void setMaxFrameRate(int framesPerSecond);
+
+    // With OpenGL requested, the background and analyzer traces are drawn by the GL renderer as
+    // soon as its context is up; until then (or if it never comes up) everything is painted in
+    // software. The editor attaches the context and must leave this component's area unfilled
+    // while isRenderingWithOpenGL().
+    void setOpenGLRequested(bool shouldUseOpenGL);
+    bool isRenderingWithOpenGL() const { return renderingWithOpenGL; }
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    AnalyzerGLRenderer& getGLRenderer() { return glRenderer; }
+#endif
 private:
     SimpleEqAudioProcessor& audioProcessor;
+
+    bool openGLRequested = false;
+    bool renderingWithOpenGL = false;
+    void updateRenderingMode();
+    void updateGLLayout();
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    AnalyzerGLRenderer glRenderer;
+#endif
+
+    const juce::Colour leftTraceColour{ 97u, 18u, 167u };
+    const juce::Colour rightTraceColour{ 215u, 201u, 134u };
+
+    int maxFrameRate = 60;
+    int getRequestedFrameRate() const;
+    static constexpr int maxFrameInterval = 8;
+    int frameInterval = 1;      // timer ticks between repaints
+    int ticksSinceRepaint = 0;
+    bool needsRepaint = true;
+    bool repaintPending = false;
+    double averagePaintMilliseconds = 0.0;
+    void updateFrameInterval(double paintMilliseconds);
+
     juce::Atomic<bool> parametersChanged{ false };
     MonoChain monoChain;
     void updateChain();
+    double getResponseSampleRate() const;
     void updateResponseCurve();
     juce::Path responseCurve;
+
+    // The settings monoChain was last designed from. Bands whose settings are unchanged keep
+    // both their coefficients and their cached response.
+    ChainSettings chainDesignSettings;
+    double chainSampleRate = 0.0;
+    bool chainDesigned = false;
+
+    // Shared with the path producers, which may still hold the previous one for a frame.
+    std::shared_ptr<const FrequencyAxis> frequencyAxis;
+    void updateFrequencyAxis();
+
+    // Per-band response in dB at each pixel column of the draw area, summed into the curve.
+    std::vector<float> lowCutResponse, peakResponse, highCutResponse, totalResponse;
+    bool lowCutResponseDirty = true, peakResponseDirty = true, highCutResponseDirty = true;
+    // The static grid, labels and border, rendered at backgroundScale physical pixels per point.
     juce::Image background;
+    float backgroundScale = 0.f;
+    void renderBackground(float scale);
 
     void drawTextLabels(juce::Graphics& g);
     void drawBackgroundGrid(juce::Graphics& g);
@@ -200,12 +677,14 @@ private:
     juce::Rectangle<int> getRenderArea();
     juce::Rectangle<int> getDrawArea();
 
-    PathProducer leftPathProducer, rightPathProducer;
-    bool showFFTAnalysis = true;
+    PathProducer pathProducer;
+    bool showFFTAnalysis = false;
 
     std::vector<float> getGains();
     std::vector<float> getFrequencies();
-    std::vector<float> getXs(const std::vector<float>& freqs, float left, float width);
+
+    // The offline benchmarks time updateResponseCurve on its own.
+    friend struct ResponseCurveBenchmark;
 };
 
 //==============================================================================
@@ -228,9 +707,32 @@ struct AnalyzerButton : juce::ToggleButton {
     juce::Path randomPath;
 };
 
+// Hidden readout of the processor's audio-thread instrumentation: the processBlock timing
+// histogram, redesign counts, and what the audio thread guard has caught.
+struct DiagnosticsOverlay : juce::Component, juce::Timer {
+    explicit DiagnosticsOverlay(SimpleEqAudioProcessor& p) : audioProcessor(p) {
+        setInterceptsMouseClicks(false, false);
+    }
+
+    void visibilityChanged() override {
+        if (isVisible()) {
+            startTimerHz(4);
+        }
+        else {
+            stopTimer();
+        }
+    }
+
+    void timerCallback() override { repaint(); }
+    void paint(juce::Graphics& g) override;
+
+private:
+    SimpleEqAudioProcessor& audioProcessor;
+};
+
 /**
 */
-class SimpleEqAudioProcessorEditor : public juce::AudioProcessorEditor
+class SimpleEqAudioProcessorEditor : public juce::AudioProcessorEditor, juce::ValueTree::Listener, juce::AsyncUpdater
 {
 public:
     SimpleEqAudioProcessorEditor (SimpleEqAudioProcessor&);
@@ -240,6 +742,12 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Renders the response curve through an OpenGL context when possible. Off by default; follows
+    // the OpenGLRendering state property, which the OpenGL button toggles.
+    void setOpenGLEnabled(bool shouldBeEnabled);
+
+    // Cmd/Ctrl+Shift+D shows or hides the diagnostics overlay.
+    bool keyPressed(const juce::KeyPress& key) override;
     
 private:
     // This reference is provided as a quick way for your editor to
@@ -261,9 +769,30 @@ private:
     using ButtonAttachment = ABVTS::ButtonAttachment;
     ButtonAttachment lowCutBypassButtonAttachment, peakBypassButtonAttachment, highCutBypassButtonAttachment, analyzerBypassButtonAttachment;
 
+    juce::ToggleButton openGLButton{ "OpenGL" };
+
+    // Created once the box has its items, so the attachment can select the current choice.
+    juce::ComboBox analyzerResolutionBox, analyzerModeBox, analyzerOverlapBox, frameRateBox;
+    std::unique_ptr<ABVTS::ComboBoxAttachment> analyzerResolutionBoxAttachment, analyzerModeBoxAttachment;
+
+    // Controls for the processor's StateProperties. State may be loaded on any thread, so changes
+    // reach the controls through the async update, which runs every entry of controlSyncs.
+    void attachToStateProperty(juce::ComboBox& box, const juce::Identifier& property, int defaultIndex);
+    void attachToStateProperty(juce::Button& button, const juce::Identifier& property, bool defaultState, std::function<void(bool)> onToggle);
+    std::vector<std::function<void()>> controlSyncs;
+    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override { triggerAsyncUpdate(); }
+    void valueTreeRedirected(juce::ValueTree&) override { triggerAsyncUpdate(); }
+    void handleAsyncUpdate() override;
+
     std::vector<juce::Component*> getComps();
 
-    LookAndFeel lnf;
+    DiagnosticsOverlay diagnosticsOverlay;
+
+    juce::SharedResourcePointer<LookAndFeel> lnf;
+
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    juce::OpenGLContext openGLContext;
+#endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEqAudioProcessorEditor)
 };
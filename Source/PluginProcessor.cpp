@@ -9,6 +9,68 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+#if JUCE_WINDOWS
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+#if SIMPLEEQ_AUDIO_THREAD_GUARD
+// On Windows each module links its own operator new, so these replace only the plugin's, JUCE
+// calls included; the debug CRT's hook adds malloc and the rest of its family (made by any
+// module sharing the CRT, but counted only inside a Scope). Elsewhere the replacements aren't
+// private to the plugin: depending on how the host loads it they replace the host's operator new
+// too, or are shadowed by it and count nothing. malloc isn't interposed there, as that would
+// reach into every allocation the host makes.
+ #define SIMPLEEQ_ON_ALLOCATION() AudioThreadGuard::noteAllocation()
+ #define SIMPLEEQ_HOOK_MALLOC_FAMILY JUCE_WINDOWS
+ #include "AllocationHooks.h"
+#endif
+
+//==============================================================================
+#if JUCE_WINDOWS
+WorkerSemaphore::WorkerSemaphore() : handle(CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr)) {}
+WorkerSemaphore::~WorkerSemaphore() { CloseHandle(handle); }
+void WorkerSemaphore::post(int count) {
+    if (count > 0) {
+        ReleaseSemaphore(handle, count, nullptr);
+    }
+}
+void WorkerSemaphore::wait() { WaitForSingleObject(handle, INFINITE); }
+#elif JUCE_MAC || JUCE_IOS
+WorkerSemaphore::WorkerSemaphore() : handle(dispatch_semaphore_create(0)) {}
+WorkerSemaphore::~WorkerSemaphore() { dispatch_release(static_cast<dispatch_semaphore_t>(handle)); }
+void WorkerSemaphore::post(int count) {
+    for (int i = 0; i < count; ++i) {
+        dispatch_semaphore_signal(static_cast<dispatch_semaphore_t>(handle));
+    }
+}
+void WorkerSemaphore::wait() { dispatch_semaphore_wait(static_cast<dispatch_semaphore_t>(handle), DISPATCH_TIME_FOREVER); }
+#else
+WorkerSemaphore::WorkerSemaphore() : handle(new sem_t) { sem_init(static_cast<sem_t*>(handle), 0, 0); }
+WorkerSemaphore::~WorkerSemaphore() {
+    sem_destroy(static_cast<sem_t*>(handle));
+    delete static_cast<sem_t*>(handle);
+}
+void WorkerSemaphore::post(int count) {
+    for (int i = 0; i < count; ++i) {
+        sem_post(static_cast<sem_t*>(handle));
+    }
+}
+void WorkerSemaphore::wait() {
+    while (sem_wait(static_cast<sem_t*>(handle)) == -1 && errno == EINTR) {}
+}
+#endif
+
 //==============================================================================
 SimpleEqAudioProcessor::SimpleEqAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -22,10 +84,29 @@ SimpleEqAudioProcessor::SimpleEqAudioProcessor()
                        )
 #endif
 {
+    for (auto* param : getParameters()) {
+        param->addListener(this);
+    }
+    smoothingParameter = apvts.getRawParameterValue("Smoothing");
+    oversamplingParameter = apvts.getRawParameterValue("Oversampling");
+    oversamplingFilterParameter = apvts.getRawParameterValue("Oversampling Filter");
+    oversamplingParameterIndex = apvts.getParameter("Oversampling")->getParameterIndex();
+    oversamplingFilterParameterIndex = apvts.getParameter("Oversampling Filter")->getParameterIndex();
+    phaseModeParameter = apvts.getRawParameterValue("Phase Mode");
+    phaseModeParameterIndex = apvts.getParameter("Phase Mode")->getParameterIndex();
+    apvts.state.addListener(this);
+    coefficientDesignThread->addClient(this);
 }
 
 SimpleEqAudioProcessor::~SimpleEqAudioProcessor()
 {
+    apvts.state.removeListener(this);
+    cancelPendingUpdate();
+    coefficientDesignThread->removeClient(this);
+    kernelDesignThread.stopThread(1000);
+    for (auto* param : getParameters()) {
+        param->removeListener(this);
+    }
 }
 
 //==============================================================================
@@ -63,7 +144,10 @@ bool SimpleEqAudioProcessor::isMidiEffect() const
 
 double SimpleEqAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // An FIR kernel rings on for the half of it past its centre, and the oversampling filters for
+    // about as long as they delay; both are host-rate samples.
+    auto sampleRate = getSampleRate();
+    return sampleRate > 0 ? (firKernelSize / 2 + oversamplerTailSamples.load()) / sampleRate : 0.0;
 }
 
 int SimpleEqAudioProcessor::getNumPrograms()
@@ -93,18 +177,94 @@ void SimpleEqAudioProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void SimpleEqAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    prepareProcessing(sampleRate, samplesPerBlock);
+
+    leftChannelFifo.prepare(samplesPerBlock);
+    rightChannelFifo.prepare(samplesPerBlock);
+}
+
+void SimpleEqAudioProcessor::prepareProcessing(double sampleRate, int samplesPerBlock)
+{
+    // The FIR modes run at the host rate; oversampling only helps the IIR designs.
+    phaseMode = juce::jlimit(0, 2, (int)phaseModeParameter->load());
+    oversamplingOrder = phaseMode == minimumPhase ? juce::jlimit(0, 2, (int)oversamplingParameter->load()) : 0;
+    oversamplingFilterType = juce::jlimit(0, 1, (int)oversamplingFilterParameter->load());
+    if (oversamplingOrder > 0) {
+        using Oversampling = juce::dsp::Oversampling<float>;
+        auto filterType = oversamplingFilterType == 0 ? Oversampling::filterHalfBandPolyphaseIIR : Oversampling::filterHalfBandFIREquiripple;
+        // Every channel the buffer can carry goes through the filters, so all of them need the delay.
+        oversampledNumChannels = juce::jlimit(1, maxSupportedChannels, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+        oversamplingBlockSize = samplesPerBlock;
+        oversampler = std::make_unique<Oversampling>((size_t)oversampledNumChannels, (size_t)oversamplingOrder, filterType, true, true);
+        oversampler->initProcessing((size_t)samplesPerBlock);
+        setLatencySamples(juce::roundToInt(oversampler->getLatencyInSamples()));
+        oversamplerTailSamples = (int)std::ceil(oversampler->getLatencyInSamples());
+    }
+    else {
+        oversampler.reset();
+        setLatencySamples(0);
+        oversamplerTailSamples = 0;
+    }
+
+    // The chain runs at the oversampled rate; the dry path and the analyzer stay at the host rate.
+    auto oversamplingFactor = 1 << oversamplingOrder;
+    processingSampleRate = sampleRate * oversamplingFactor;
+    auto chainBlockSize = samplesPerBlock * oversamplingFactor;
+
+    auto chainSettings = getChainSettings(apvts);
+    ChainCoefficients coefficients;
+    BandDesignCounts counts;
+    designChainCoefficients(chainSettings, processingSampleRate, coefficients, true, &coefficientDesignCache.get(), &counts);
+    countDesigns(counts);
+
+    applyAllBands = true;
+    applyCoefficients(coefficients);
+    applyAllBands = true;
+    latestDesignedCoefficients = nullptr;
+
+    smoothingActive = false;
+    resetSmoothers(chainSettings);
+
     juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = chainBlockSize;
     spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    spec.sampleRate = processingSampleRate;
+    chain.prepare(spec);
 
-    updateFilters();
+    constexpr auto numLanes = (int)SIMDSample::size();
+    auto numChannelGroups = (juce::jmax(1, getTotalNumOutputChannels()) + numLanes - 1) / numLanes;
+    chainPool.resize((size_t)(numChannelGroups - 1));
+    for (auto& pooledChain : chainPool) {
+        if (pooledChain == nullptr) {
+            pooledChain = std::make_unique<SIMDChain>();
+        }
+        shareCoefficients(chain, *pooledChain);
+        pooledChain->prepare(spec);
+    }
+    syncChainPoolBypassStates();
+    interleaved = juce::dsp::AudioBlock<SIMDSample>(interleavedData, 1, (size_t)chainBlockSize);
+    pooledInterleavedData.resize(chainPool.size());
+    pooledInterleaved.resize(chainPool.size());
+    for (size_t i = 0; i < chainPool.size(); ++i) {
+        pooledInterleaved[i] = juce::dsp::AudioBlock<SIMDSample>(pooledInterleavedData[i], 1, (size_t)chainBlockSize);
+    }
 
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    startWorkerPoolIfNeeded();
+
+    if (phaseMode == minimumPhase) {
+        releaseLinearPhase();
+    }
+    else {
+        prepareLinearPhase(sampleRate, samplesPerBlock);
+    }
 
+    dryBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    wetLevel.reset(sampleRate, transparencyFadeSeconds);
+    wetLevel.setCurrentAndTargetValue(chainIsTransparent && getLatencySamples() == 0 ? 0.f : 1.f);
+    chainNeedsReset = false;
+
+    designSampleRate = processingSampleRate;
+    coefficientDesignThread->requestDesign();
 
     spec.numChannels = getTotalNumOutputChannels();
 }
@@ -122,12 +282,10 @@ bool SimpleEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to maxSupportedChannels works, surround included: each group of
+    // SIMDSample::size() channels runs through its own chain from the pool.
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxSupportedChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -144,6 +302,8 @@ bool SimpleEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void SimpleEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const AudioThreadGuard::Scope audioThreadScope;
+    const ScopedProcessTimer processTimer(*this, buffer.getNumSamples());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -158,27 +318,289 @@ void SimpleEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
         buffer.clear(i, 0, buffer.getNumSamples());
     }
     
-    updateFilters();
+    auto numSamples = buffer.getNumSamples();
+    auto subBlockSize = getSmoothingSubBlockSize();
+    updateSmoothingMode(subBlockSize > 0);
+
+    if (!smoothingActive) {
+        updateFilters();
+    }
 
-   
+    // Skipping the chain would also skip its latency, so a chain with latency always runs.
+    wetLevel.setTargetValue(chainIsTransparent && getLatencySamples() == 0 ? 0.f : 1.f);
+    if (!wetLevel.isSmoothing() && wetLevel.getCurrentValue() == 0.f) {
+        if (smoothingActive) {
+            updateSmoothedFilters(numSamples);
+        }
+        chainNeedsReset = true;
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    
+        updateAnalyzerFifos(buffer);
+        return;
+    }
+
+    // The filters last ran on audio from before the transparent stretch; start them from silence.
+    if (chainNeedsReset) {
+        chain.reset();
+        for (auto& pooledChain : chainPool) {
+            pooledChain->reset();
+        }
+        chainNeedsReset = false;
+    }
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    auto crossfading = wetLevel.isSmoothing();
+    if (crossfading) {
+        if (numSamples <= dryBuffer.getNumSamples()) {
+            for (int channel = 0; channel < juce::jmin(buffer.getNumChannels(), dryBuffer.getNumChannels()); ++channel) {
+                dryBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+            }
+        }
+        else {
+            wetLevel.setCurrentAndTargetValue(wetLevel.getTargetValue());
+            crossfading = false;
+        }
+    }
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if (!convolutions.empty()) {
+        processLinearPhase(buffer);
+    }
+    else if (oversampler != nullptr) {
+        processOversampled(buffer, subBlockSize);
+    }
+    else {
+        processFilters(buffer, subBlockSize);
+    }
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if (crossfading) {
+        applyCrossfade(buffer);
+    }
 
+    updateAnalyzerFifos(buffer);
+}
 
+void SimpleEqAudioProcessor::updateAnalyzerFifos(const juce::AudioBuffer<float>& buffer) {
+    if (analyzerConsumers.load() == 0) {
+        return;
+    }
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
 }
 
+void SimpleEqAudioProcessor::applyCrossfade(juce::AudioBuffer<float>& buffer) {
+    auto numChannels = juce::jmin(buffer.getNumChannels(), dryBuffer.getNumChannels());
+    auto* const* wet = buffer.getArrayOfWritePointers();
+    auto* const* dry = dryBuffer.getArrayOfReadPointers();
+
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+        auto level = wetLevel.getNextValue();
+        for (int channel = 0; channel < numChannels; ++channel) {
+            wet[channel][i] = dry[channel][i] + level * (wet[channel][i] - dry[channel][i]);
+        }
+    }
+}
+
+void SimpleEqAudioProcessor::processFilters(juce::AudioBuffer<float>& buffer, int subBlockSize) {
+    auto numSamples = buffer.getNumSamples();
+    if (smoothingActive) {
+        for (int start = 0; start < numSamples; start += subBlockSize) {
+            auto subBlockSamples = juce::jmin(subBlockSize, numSamples - start);
+            updateSmoothedFilters(subBlockSamples);
+            processChain(buffer, start, subBlockSamples);
+        }
+    }
+    else {
+        processChain(buffer, 0, numSamples);
+    }
+}
+
+void SimpleEqAudioProcessor::processOversampled(juce::AudioBuffer<float>& buffer, int subBlockSize) {
+    auto factor = (int)oversampler->getOversamplingFactor();
+    auto numChannels = juce::jmin(buffer.getNumChannels(), oversampledNumChannels);
+
+    // Beyond maxSupportedChannels (which a supported layout never reaches) nothing could line
+    // these up with the delayed channels, so silence them rather than let them run early.
+    for (int channel = numChannels; channel < buffer.getNumChannels(); ++channel) {
+        buffer.clear(channel, 0, buffer.getNumSamples());
+    }
+    auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, (size_t)numChannels);
+
+    // Smoothing sub-blocks keep their duration, so they cover factor times as many samples up here.
+    for (int start = 0; start < buffer.getNumSamples(); start += oversamplingBlockSize) {
+        auto chunk = block.getSubBlock((size_t)start, (size_t)juce::jmin(oversamplingBlockSize, buffer.getNumSamples() - start));
+        auto oversampled = oversampler->processSamplesUp(chunk);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            oversampledChannels[(size_t)channel] = oversampled.getChannelPointer((size_t)channel);
+        }
+        juce::AudioBuffer<float> oversampledBuffer(oversampledChannels.data(), numChannels, (int)oversampled.getNumSamples());
+        processFilters(oversampledBuffer, subBlockSize * factor);
+
+        oversampler->processSamplesDown(chunk);
+    }
+}
+
+void SimpleEqAudioProcessor::processLinearPhase(juce::AudioBuffer<float>& buffer) {
+    auto block = juce::dsp::AudioBlock<float>(buffer);
+    for (size_t pair = 0; pair < convolutions.size(); ++pair) {
+        auto firstChannel = 2 * pair;
+        if (firstChannel >= block.getNumChannels()) {
+            break;
+        }
+        auto pairBlock = block.getSubsetChannelBlock(firstChannel, juce::jmin((size_t)2, block.getNumChannels() - firstChannel));
+        juce::dsp::ProcessContextReplacing<float> context(pairBlock);
+        convolutions[pair]->process(context);
+    }
+}
+
+void SimpleEqAudioProcessor::updateParallelThreshold() {
+    const auto& thresholds = StateProperties::parallelProcessingThresholds;
+    auto index = juce::jlimit(0, (int)thresholds.size() - 1,
+                              (int)apvts.state.getProperty(StateProperties::parallelProcessing, StateProperties::parallelProcessingDefault));
+    parallelThreshold = thresholds[(size_t)index];
+    // The workers are started off the audio thread, and before processBlock can need them.
+    triggerAsyncUpdate();
+}
+
+void SimpleEqAudioProcessor::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) {
+    if (tree == apvts.state && property == StateProperties::parallelProcessing) {
+        updateParallelThreshold();
+    }
+}
+
+void SimpleEqAudioProcessor::startWorkerPoolIfNeeded() {
+    // The audio thread takes one group itself, so a worker per remaining group (within the cores)
+    // is enough. The pool is shared and never shrinks, so the workers of one instance serve all.
+    if (getParallelThreshold() > 0) {
+        auto numWorkers = juce::jmin(maxSupportedChannels / (int)SIMDSample::size() - 1, juce::SystemStats::getNumCpus() - 1);
+        if (numWorkers > 0) {
+            workerPool->start(numWorkers);
+        }
+    }
+}
+
+void SimpleEqAudioProcessor::handleAsyncUpdate() {
+    startWorkerPoolIfNeeded();
+
+    auto requestedPhaseMode = juce::jlimit(0, 2, (int)phaseModeParameter->load());
+    auto order = requestedPhaseMode == minimumPhase ? juce::jlimit(0, 2, (int)oversamplingParameter->load()) : 0;
+    auto filterType = juce::jlimit(0, 1, (int)oversamplingFilterParameter->load());
+    if (requestedPhaseMode == phaseMode && order == oversamplingOrder && (order == 0 || filterType == oversamplingFilterType)) {
+        return;
+    }
+
+    // Not prepared yet; the next prepareToPlay picks the mode up.
+    if (getSampleRate() <= 0 || getBlockSize() <= 0) {
+        return;
+    }
+
+    // The analyzer FIFOs run at the host rate and the editor may be reading them right now, so only
+    // the processing side is re-prepared. The redesign counters it bumps are atomic.
+    suspendProcessing(true);
+    prepareProcessing(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+}
+
+void SimpleEqAudioProcessor::processChain(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    constexpr auto numLanes = (int)SIMDSample::size();
+    if (interleaved.getNumSamples() == 0) {
+        return;
+    }
+
+    syncChainPoolBypassStates();
+
+    // Channels beyond what the pool was prepared for (which a well-behaved host never sends) pass through.
+    auto numChannelGroups = juce::jmin((buffer.getNumChannels() + numLanes - 1) / numLanes, 1 + (int)chainPool.size());
+
+    auto threshold = getParallelThreshold();
+    if (numChannelGroups > 1 && threshold > 0 && workerPool->getNumWorkers() > 0
+        && buffer.getNumChannels() * numSamples >= threshold) {
+        struct Job {
+            SimpleEqAudioProcessor& processor;
+            juce::AudioBuffer<float>& buffer;
+            int startSample, numSamples;
+        } job{ *this, buffer, startSample, numSamples };
+
+        // Another instance holds the pool for this moment, so do the groups here instead.
+        if (workerPool->run(numChannelGroups, [](void* context, int group) {
+                auto& j = *static_cast<Job*>(context);
+                j.processor.processChannelGroup(group, j.buffer, j.startSample, j.numSamples);
+            }, &job)) {
+            return;
+        }
+    }
+
+    for (int group = 0; group < numChannelGroups; ++group) {
+        processChannelGroup(group, buffer, startSample, numSamples);
+    }
+}
+
+void SimpleEqAudioProcessor::processChannelGroup(int group, juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    constexpr auto numLanes = (int)SIMDSample::size();
+    auto& groupChain = group == 0 ? chain : *chainPool[(size_t)(group - 1)];
+    auto& groupInterleaved = group == 0 ? interleaved : pooledInterleaved[(size_t)(group - 1)];
+    auto maxBlockSize = (int)groupInterleaved.getNumSamples();
+    auto firstChannel = group * numLanes;
+    auto numChannels = juce::jmin(numLanes, buffer.getNumChannels() - firstChannel);
+
+    // Some hosts exceed the block size promised in prepareToPlay, so work in chunks that fit.
+    auto end = startSample + numSamples;
+    for (int start = startSample; start < end; start += maxBlockSize) {
+        auto chunkSize = juce::jmin(maxBlockSize, end - start);
+        auto block = groupInterleaved.getSubBlock(0, (size_t)chunkSize);
+
+        interleaveChannels(buffer, firstChannel, numChannels, start, block);
+        juce::dsp::ProcessContextReplacing<SIMDSample> context(block);
+        groupChain.process(context);
+        deinterleaveChannels(block, buffer, firstChannel, numChannels, start);
+    }
+}
+
+void shareCoefficients(const SIMDChain& lead, SIMDChain& follower) {
+    follower.get<ChainPositions::LowCut>().shareCascadeWith(lead.get<ChainPositions::LowCut>());
+    follower.get<ChainPositions::Peak>().coefficients = lead.get<ChainPositions::Peak>().coefficients;
+    follower.get<ChainPositions::HighCut>().shareCascadeWith(lead.get<ChainPositions::HighCut>());
+}
+
+void SimpleEqAudioProcessor::syncChainPoolBypassStates() {
+    for (auto& pooledChain : chainPool) {
+        pooledChain->setBypassed<ChainPositions::LowCut>(chain.isBypassed<ChainPositions::LowCut>());
+        pooledChain->setBypassed<ChainPositions::Peak>(chain.isBypassed<ChainPositions::Peak>());
+        pooledChain->setBypassed<ChainPositions::HighCut>(chain.isBypassed<ChainPositions::HighCut>());
+    }
+}
+
+void interleaveChannels(const juce::AudioBuffer<float>& buffer, int firstChannel, int numChannels, int startSample, juce::dsp::AudioBlock<SIMDSample>& interleaved) {
+    constexpr auto numLanes = (int)SIMDSample::size();
+    auto numSamples = (int)interleaved.getNumSamples();
+    auto* lanes = reinterpret_cast<float*>(interleaved.getChannelPointer(0));
+
+    for (int lane = 0; lane < numLanes; ++lane) {
+        if (lane < numChannels) {
+            auto* source = buffer.getReadPointer(firstChannel + lane, startSample);
+            for (int i = 0; i < numSamples; ++i) {
+                lanes[i * numLanes + lane] = source[i];
+            }
+        }
+        else {
+            for (int i = 0; i < numSamples; ++i) {
+                lanes[i * numLanes + lane] = 0.f;
+            }
+        }
+    }
+}
+
+void deinterleaveChannels(const juce::dsp::AudioBlock<SIMDSample>& interleaved, juce::AudioBuffer<float>& buffer, int firstChannel, int numChannels, int startSample) {
+    constexpr auto numLanes = (int)SIMDSample::size();
+    auto numSamples = (int)interleaved.getNumSamples();
+    auto* lanes = reinterpret_cast<const float*>(interleaved.getChannelPointer(0));
+
+    for (int lane = 0; lane < numChannels; ++lane) {
+        auto* destination = buffer.getWritePointer(firstChannel + lane, startSample);
+        for (int i = 0; i < numSamples; ++i) {
+            destination[i] = lanes[i * numLanes + lane];
+        }
+    }
+}
+
 //==============================================================================
 bool SimpleEqAudioProcessor::hasEditor() const
 {
@@ -192,14 +614,58 @@ juce::AudioProcessorEditor* SimpleEqAudioProcessor::createEditor()
 }
 
 //==============================================================================
+namespace {
+// State is the apvts ValueTree, exactly as older versions wrote and read it, followed by a binary
+// block and a trailer giving the block's size and the magic. Older versions read the tree and never
+// look past it; this one finds the block from the end and only falls back to the tree without it.
+// Binary block: magic, version, parameter count, one denormalised float per parameter in
+// stateParameterIDs order, then an FNV-1a checksum of everything before it. Later versions may
+// only append parameters, so any version can be read up to the parameters it shares with this one.
+// Version 1 wrote the block alone, without the tree or the trailer.
+constexpr juce::uint32 binaryStateMagic = 0x42514553; // "SEQB"
+constexpr juce::uint16 binaryStateVersion = 2;
+constexpr std::array<const char*, 17> stateParameterIDs{
+    "LowCut Freq", "HighCut Freq", "Peak Freq", "Peak Gain", "Peak Quality",
+    "LowCut Slope", "HighCut Slope",
+    "LowCut Bypassed", "Peak Bypassed", "HighCut Bypassed",
+    "Analyzer Enabled", "Analyzer Resolution", "Analyzer Mode",
+    "Smoothing", "Oversampling", "Oversampling Filter", "Phase Mode"
+};
+constexpr size_t binaryStateHeaderSize = 8, binaryStateChecksumSize = 4, binaryStateTrailerSize = 8;
+
+juce::uint32 binaryStateChecksum(const void* data, size_t numBytes) {
+    auto hash = (juce::uint32)2166136261u;
+    for (auto* byte = static_cast<const juce::uint8*>(data); byte != static_cast<const juce::uint8*>(data) + numBytes; ++byte) {
+        hash = (hash ^ *byte) * 16777619u;
+    }
+    return hash;
+}
+}
+
 void SimpleEqAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
 
+    // Every parameter has to be listed, or the binary block would silently drop it.
+    jassert(stateParameterIDs.size() == (size_t)getParameters().size());
+
     juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    apvts.copyState().writeToStream(mos);
+
+    auto blockStart = mos.getDataSize();
+    mos.writeInt((int)binaryStateMagic);
+    mos.writeShort((short)binaryStateVersion);
+    mos.writeShort((short)stateParameterIDs.size());
+    for (auto* id : stateParameterIDs) {
+        mos.writeFloat(apvts.getRawParameterValue(id)->load());
+    }
+    auto blockSize = mos.getDataSize() - blockStart;
+    mos.writeInt((int)binaryStateChecksum(static_cast<const char*>(mos.getData()) + blockStart, blockSize));
+
+    mos.writeInt((int)(blockSize + binaryStateChecksumSize));
+    mos.writeInt((int)binaryStateMagic);
 }
 
 void SimpleEqAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -207,13 +673,81 @@ void SimpleEqAudioProcessor::setStateInformation (const void* data, int sizeInBy
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
 
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    // The trailer points back at the binary block; version 1 state is the block alone.
+    if (sizeInBytes >= (int)binaryStateTrailerSize) {
+        auto* trailer = static_cast<const char*>(data) + sizeInBytes - binaryStateTrailerSize;
+        auto blockSize = (size_t)juce::ByteOrder::littleEndianInt(trailer);
+        if ((juce::uint32)juce::ByteOrder::littleEndianInt(trailer + 4) == binaryStateMagic
+            && blockSize <= (size_t)sizeInBytes - binaryStateTrailerSize
+            && setBinaryStateInformation(trailer - blockSize, (int)blockSize)) {
+            // The block only holds parameters; the state properties come from the tree before it.
+            auto treeSize = (size_t)sizeInBytes - binaryStateTrailerSize - blockSize;
+            restoreStateProperties(juce::ValueTree::readFromData(data, treeSize));
+            return;
+        }
+    }
+    if (setBinaryStateInformation(data, sizeInBytes)) {
+        restoreStateProperties({});
+        return;
+    }
+
+    auto tree = juce::ValueTree::readFromData(data, (size_t)sizeInBytes);
     if (tree.isValid()) {
         apvts.replaceState(tree);
         //updateFilters();
     }
 }
 
+void SimpleEqAudioProcessor::restoreStateProperties(const juce::ValueTree& saved) {
+    for (const auto& id : StateProperties::all) {
+        if (saved.hasProperty(id)) {
+            apvts.state.setProperty(id, saved[id], nullptr);
+        }
+        else {
+            apvts.state.removeProperty(id, nullptr);
+        }
+    }
+}
+
+bool SimpleEqAudioProcessor::setBinaryStateInformation(const void* data, int sizeInBytes) {
+    if (sizeInBytes < (int)(binaryStateHeaderSize + binaryStateChecksumSize)) {
+        return false;
+    }
+
+    juce::MemoryInputStream mis(data, (size_t)sizeInBytes, false);
+    if ((juce::uint32)mis.readInt() != binaryStateMagic) {
+        return false;
+    }
+    auto version = (juce::uint16)mis.readShort();
+    auto numParameters = (size_t)(juce::uint16)mis.readShort();
+    auto payloadSize = binaryStateHeaderSize + numParameters * sizeof(float);
+    if (version < 1 || (size_t)sizeInBytes < payloadSize + binaryStateChecksumSize) {
+        return false;
+    }
+
+    auto* checksumPosition = static_cast<const char*>(data) + payloadSize;
+    if ((juce::uint32)juce::ByteOrder::littleEndianInt(checksumPosition) != binaryStateChecksum(data, payloadSize)) {
+        return false;
+    }
+
+    // Only parameters whose value actually differs are touched, so an unchanged instance loads
+    // without a single listener callback. Parameters newer than the state go back to their
+    // defaults, as they would when loading the same state into a fresh instance.
+    for (size_t i = 0; i < stateParameterIDs.size(); ++i) {
+        auto* parameter = apvts.getParameter(stateParameterIDs[i]);
+        if (i < numParameters) {
+            auto value = mis.readFloat();
+            if (parameter != nullptr && apvts.getRawParameterValue(stateParameterIDs[i])->load() != value) {
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            }
+        }
+        else if (parameter != nullptr && parameter->getValue() != parameter->getDefaultValue()) {
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+        }
+    }
+    return true;
+}
+
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) {
     ChainSettings settings;
     settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
@@ -236,49 +770,394 @@ Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRat
 }
 
 
-void SimpleEqAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+void designChainCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& coefficients, bool forceFullDesign,
+                             CoefficientDesignCache* cache, BandDesignCounts* counts) {
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+    // Mirrors FilterDesign's even-order Butterworth decomposition into second-order sections.
+    auto designButterworthStages = [](std::array<ChainCoefficients::Biquad, 4>& stages, Slope slope, auto&& makeSection) {
+        const auto order = 2 * (slope + 1);
+        for (int i = 0; i < order / 2; ++i) {
+            auto q = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+            stages[i] = makeSection(static_cast<float>(q));
+        }
+    };
+
+    // Stages beyond a cut's slope are never applied, so their contents don't matter to the cache.
+    auto designCached = [cache, counts](ChainPositions band, const CoefficientDesignCache::Key& key, CoefficientDesignCache::Stages& stages, auto&& design) {
+        if (cache != nullptr && cache->find(key, stages)) {
+            if (counts != nullptr) {
+                ++counts->cacheHits[band];
+            }
+            return;
+        }
+        design();
+        if (counts != nullptr) {
+            ++counts->designs[band];
+        }
+        if (cache != nullptr) {
+            cache->insert(key, stages);
+        }
+    };
+
+    forceFullDesign = forceFullDesign || sampleRate != coefficients.sampleRate;
+
+    if (forceFullDesign || lowCutDesignChanged(chainSettings, coefficients.settings)) {
+        designCached(ChainPositions::LowCut, CoefficientDesignCache::makeLowCutKey(chainSettings, sampleRate), coefficients.lowCut, [&] {
+            designButterworthStages(coefficients.lowCut, chainSettings.lowCutSlope, [&](float q) {
+                return ArrayCoefficients::makeHighPass(sampleRate, chainSettings.lowCutFreq, q);
+            });
+        });
+        ++coefficients.lowCutVersion;
+    }
+
+    if (forceFullDesign || highCutDesignChanged(chainSettings, coefficients.settings)) {
+        designCached(ChainPositions::HighCut, CoefficientDesignCache::makeHighCutKey(chainSettings, sampleRate), coefficients.highCut, [&] {
+            designButterworthStages(coefficients.highCut, chainSettings.highCutSlope, [&](float q) {
+                return ArrayCoefficients::makeLowPass(sampleRate, chainSettings.highCutFreq, q);
+            });
+        });
+        ++coefficients.highCutVersion;
+    }
+
+    if (forceFullDesign || peakDesignChanged(chainSettings, coefficients.settings)) {
+        CoefficientDesignCache::Stages peakStages;
+        designCached(ChainPositions::Peak, CoefficientDesignCache::makePeakKey(chainSettings, sampleRate), peakStages, [&] {
+            peakStages[0] = ArrayCoefficients::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+        });
+        coefficients.peak = peakStages[0];
+        ++coefficients.peakVersion;
+    }
 
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    coefficients.settings = chainSettings;
+    coefficients.sampleRate = sampleRate;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+void SimpleEqAudioProcessor::updatePeakFilter(const ChainCoefficients& coefficients) {
+    updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, coefficients.peak);
 }
 
 void updateCoefficients(Coefficients& old, const Coefficients& replacements) {
     *old = *replacements;
 }
 
-void SimpleEqAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings) {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+void updateCoefficients(Coefficients& old, const ChainCoefficients::Biquad& replacements) {
+    *old = replacements;
+}
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+void SimpleEqAudioProcessor::updateLowCutFilters(const ChainCoefficients& coefficients) {
+    chain.get<ChainPositions::LowCut>().setCoefficients(coefficients.lowCut, coefficients.settings.lowCutSlope);
+}
 
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
+void SimpleEqAudioProcessor::updateHighCutFilters(const ChainCoefficients& coefficients) {
+    chain.get<ChainPositions::HighCut>().setCoefficients(coefficients.highCut, coefficients.settings.highCutSlope);
 }
 
-void SimpleEqAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings) {
-    auto cutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+void SimpleEqAudioProcessor::updateBypassStates(const ChainSettings& chainSettings) {
+    chain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    chain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    chain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+}
 
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+void SimpleEqAudioProcessor::applyCoefficients(const ChainCoefficients& coefficients) {
+    // A set designed before the last prepareToPlay is stale.
+    if (coefficients.sampleRate != processingSampleRate) {
+        return;
+    }
 
-    updateCutFilter(rightHighCut, cutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(leftHighCut, cutCoefficients, chainSettings.highCutSlope);
+    if (applyAllBands || coefficients.lowCutVersion != appliedLowCutVersion) {
+        updateLowCutFilters(coefficients);
+        appliedLowCutVersion = coefficients.lowCutVersion;
+    }
+    if (applyAllBands || coefficients.highCutVersion != appliedHighCutVersion) {
+        updateHighCutFilters(coefficients);
+        appliedHighCutVersion = coefficients.highCutVersion;
+    }
+    if (applyAllBands || coefficients.peakVersion != appliedPeakVersion) {
+        updatePeakFilter(coefficients);
+        appliedPeakVersion = coefficients.peakVersion;
+    }
+    updateBypassStates(coefficients.settings);
+    chainIsTransparent = isChainTransparent(coefficients.settings);
+
+    applyAllBands = false;
 }
 
 void SimpleEqAudioProcessor::updateFilters() {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
+    if (auto* coefficients = coefficientSlot.pull()) {
+        latestDesignedCoefficients = coefficients;
+        applyCoefficients(*coefficients);
+    }
+}
+
+int SimpleEqAudioProcessor::getSmoothingSubBlockSize() const {
+    static constexpr std::array<int, 4> subBlockSizes{ 0, 16, 32, 64 };
+    auto index = juce::jlimit(0, (int)subBlockSizes.size() - 1, (int)smoothingParameter->load());
+    return subBlockSizes[(size_t)index];
+}
+
+void SimpleEqAudioProcessor::resetSmoothers(const ChainSettings& chainSettings) {
+    lowCutFreqSmoother.reset(processingSampleRate, smoothingRampSeconds);
+    highCutFreqSmoother.reset(processingSampleRate, smoothingRampSeconds);
+    peakFreqSmoother.reset(processingSampleRate, smoothingRampSeconds);
+    peakGainSmoother.reset(processingSampleRate, smoothingRampSeconds);
+    peakQualitySmoother.reset(processingSampleRate, smoothingRampSeconds);
+
+    lowCutFreqSmoother.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreqSmoother.setCurrentAndTargetValue(chainSettings.highCutFreq);
+    peakFreqSmoother.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakGainSmoother.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+    peakQualitySmoother.setCurrentAndTargetValue(chainSettings.peakQuality);
+}
+
+void SimpleEqAudioProcessor::updateSmoothingMode(bool shouldSmooth) {
+    if (shouldSmooth == smoothingActive) {
+        return;
+    }
+    smoothingActive = shouldSmooth;
+    applyAllBands = true;
+
+    if (smoothingActive) {
+        // Start from the current settings so that switching modes doesn't ramp from stale values.
+        smoothedSettingsVersion = settingsVersion.load();
+        smoothingTarget = getChainSettings(apvts);
+        resetSmoothers(smoothingTarget);
+        smoothedSettingsDirty = true;
+    }
+    else if (latestDesignedCoefficients != nullptr) {
+        applyCoefficients(*latestDesignedCoefficients);
+    }
+}
+
+void SimpleEqAudioProcessor::updateSmoothedFilters(int numSamples) {
+    // Keep draining the designer so its latest set is at hand when smoothing is switched off.
+    if (auto* coefficients = coefficientSlot.pull()) {
+        latestDesignedCoefficients = coefficients;
+    }
+
+    auto version = settingsVersion.load();
+    if (version != smoothedSettingsVersion) {
+        smoothedSettingsVersion = version;
+        smoothingTarget = getChainSettings(apvts);
+        lowCutFreqSmoother.setTargetValue(smoothingTarget.lowCutFreq);
+        highCutFreqSmoother.setTargetValue(smoothingTarget.highCutFreq);
+        peakFreqSmoother.setTargetValue(smoothingTarget.peakFreq);
+        peakGainSmoother.setTargetValue(smoothingTarget.peakGainInDecibels);
+        peakQualitySmoother.setTargetValue(smoothingTarget.peakQuality);
+        smoothedSettingsDirty = true;
+    }
+
+    auto isSmoothing = lowCutFreqSmoother.isSmoothing() || highCutFreqSmoother.isSmoothing() || peakFreqSmoother.isSmoothing()
+        || peakGainSmoother.isSmoothing() || peakQualitySmoother.isSmoothing();
+
+    if (!isSmoothing && !smoothedSettingsDirty) {
+        return;
+    }
+    smoothedSettingsDirty = false;
+
+    auto chainSettings = smoothingTarget;
+    chainSettings.lowCutFreq = lowCutFreqSmoother.skip(numSamples);
+    chainSettings.highCutFreq = highCutFreqSmoother.skip(numSamples);
+    chainSettings.peakFreq = peakFreqSmoother.skip(numSamples);
+    chainSettings.peakGainInDecibels = peakGainSmoother.skip(numSamples);
+    chainSettings.peakQuality = peakQualitySmoother.skip(numSamples);
+
+    BandDesignCounts counts;
+    designChainCoefficients(chainSettings, processingSampleRate, smoothedCoefficients, applyAllBands, nullptr, &counts);
+    countDesigns(counts);
+    applyCoefficients(smoothedCoefficients);
+}
+
+void SimpleEqAudioProcessor::designCoefficients() {
+    auto sampleRate = designSampleRate.load();
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    auto version = settingsVersion.load();
+    auto sampleRateChanged = sampleRate != designedCoefficients.sampleRate;
+    if (sampleRateChanged || version != designedSettingsVersion) {
+        designedSettingsVersion = version;
+
+        auto previous = designedCoefficients;
+        BandDesignCounts counts;
+        designChainCoefficients(getChainSettings(apvts), sampleRate, designedCoefficients, sampleRateChanged, &coefficientDesignCache.get(), &counts);
+        countDesigns(counts);
+
+        coefficientSlot.getWriteBuffer() = designedCoefficients;
+        coefficientSlot.publish();
+
+        // Most parameters (the analyzer's, the modes) leave the kernel as it is.
+        const auto& settings = designedCoefficients.settings;
+        const auto& previousSettings = previous.settings;
+        if (designedCoefficients.lowCutVersion != previous.lowCutVersion || designedCoefficients.peakVersion != previous.peakVersion
+            || designedCoefficients.highCutVersion != previous.highCutVersion || settings.lowCutBypassed != previousSettings.lowCutBypassed
+            || settings.peakBypassed != previousSettings.peakBypassed || settings.highCutBypassed != previousSettings.highCutBypassed) {
+            kernelCoefficientSlot.getWriteBuffer() = designedCoefficients;
+            kernelCoefficientSlot.publish();
+            kernelDesignThread.notify();
+        }
+    }
+}
+
+namespace {
+// |H| of the whole chain at `frequency`, from the same band designs the IIR chain runs.
+double getChainMagnitude(const ChainCoefficients& coefficients, double frequency, double sampleRate) {
+    const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    auto getBiquadMagnitude = [&z](const ChainCoefficients::Biquad& b) {
+        auto numerator = (double)b[0] + z * ((double)b[1] + z * (double)b[2]);
+        auto denominator = (double)b[3] + z * ((double)b[4] + z * (double)b[5]);
+        return std::abs(numerator / denominator);
+    };
+
+    auto magnitude = 1.0;
+    const auto& settings = coefficients.settings;
+    if (!settings.lowCutBypassed) {
+        for (int i = 0; i <= settings.lowCutSlope; ++i) {
+            magnitude *= getBiquadMagnitude(coefficients.lowCut[(size_t)i]);
+        }
+    }
+    if (!settings.peakBypassed) {
+        magnitude *= getBiquadMagnitude(coefficients.peak);
+    }
+    if (!settings.highCutBypassed) {
+        for (int i = 0; i <= settings.highCutSlope; ++i) {
+            magnitude *= getBiquadMagnitude(coefficients.highCut[(size_t)i]);
+        }
+    }
+    return magnitude;
+}
+}
+
+void SimpleEqAudioProcessor::prepareLinearPhase(double sampleRate, int samplesPerBlock) {
+    {
+        const GuardedCriticalSection::ScopedLockType sl(linearPhaseLock);
+
+        // About 11 Hz of resolution whatever the rate, so the cut slopes keep their shape. The kernel
+        // is one tap shorter than the FFT, which gives it an odd length and a centre on a sample.
+        firFFTSize = sampleRate <= 50000.0 ? 4096 : sampleRate <= 100000.0 ? 8192 : 16384;
+        firKernelSize = firFFTSize - 1;
+        firSampleRate = sampleRate;
+        firFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(firFFTSize)));
+        firSpectrum.assign((size_t)firFFTSize, {});
+        firImpulse.assign((size_t)firFFTSize, {});
+        firWindow.resize((size_t)firKernelSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(firWindow.data(), (size_t)firKernelSize, juce::dsp::WindowingFunction<float>::blackman, false);
+
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = sampleRate;
+        spec.maximumBlockSize = (juce::uint32)samplesPerBlock;
+        spec.numChannels = 2;
+
+        using Convolution = juce::dsp::Convolution;
+        auto numChannelPairs = (juce::jmax(1, getTotalNumOutputChannels()) + 1) / 2;
+        convolutions.clear();
+        if (convolutionQueue == nullptr) {
+            convolutionQueue = std::make_unique<juce::dsp::ConvolutionMessageQueue>();
+        }
+        for (int i = 0; i < numChannelPairs; ++i) {
+            convolutions.push_back(phaseMode == linearPhaseLowLatency
+                ? std::make_unique<Convolution>(Convolution::NonUniform{ lowLatencyHeadSize }, *convolutionQueue)
+                : std::make_unique<Convolution>(Convolution::Latency{ uniformPartitionSize }, *convolutionQueue));
+            convolutions.back()->prepare(spec);
+        }
+
+        setLatencySamples(firKernelSize / 2 + convolutions.front()->getLatency());
+        kernelNeedsRebuild = true;
+    }
+
+    if (!kernelDesignThread.isThreadRunning()) {
+        kernelDesignThread.startThread();
+    }
+    kernelDesignThread.notify();
+}
+
+void SimpleEqAudioProcessor::releaseLinearPhase() {
+    // The kernel thread builds under the lock, so it has to be gone before the lock is taken here.
+    kernelDesignThread.stopThread(1000);
+
+    const GuardedCriticalSection::ScopedLockType sl(linearPhaseLock);
+    convolutions.clear();
+    convolutionQueue.reset();
+    firFFT.reset();
+    firSpectrum = {};
+    firImpulse = {};
+    firWindow = {};
+    firFFTSize = 0;
+    firKernelSize = 0;
+}
+
+void SimpleEqAudioProcessor::KernelDesignThread::run() {
+    while (!threadShouldExit()) {
+        if (!processor.rebuildLinearPhaseKernel()) {
+            wait(-1);
+            continue;
+        }
+        // Changes that arrive in the meantime coalesce into one rebuild once the interval is over.
+        auto until = juce::Time::getMillisecondCounter() + (juce::uint32)minimumRebuildIntervalMs;
+        for (auto now = juce::Time::getMillisecondCounter(); now < until && !threadShouldExit(); now = juce::Time::getMillisecondCounter()) {
+            wait((int)(until - now));
+        }
+    }
+}
+
+bool SimpleEqAudioProcessor::rebuildLinearPhaseKernel() {
+    auto pulled = false;
+    if (auto* latest = kernelCoefficientSlot.pull()) {
+        kernelCoefficients = *latest;
+        pulled = true;
+    }
+
+    const GuardedCriticalSection::ScopedLockType sl(linearPhaseLock);
+    if (convolutions.empty()) {
+        return false;
+    }
+    // The designer hasn't caught up with the last prepareToPlay; it publishes again once it has.
+    if (kernelCoefficients.sampleRate != firSampleRate) {
+        return false;
+    }
+    if (!kernelNeedsRebuild.exchange(false) && !pulled) {
+        return false;
+    }
+
+    // A real, symmetric spectrum gives a zero-phase impulse centred on sample 0. Rotating it to the
+    // middle of the odd-length kernel makes it causal and exactly linear phase, since the window is
+    // symmetric about that same sample; the window tames the truncation.
+    auto size = firFFTSize;
+    for (int k = 0; k < size; ++k) {
+        auto bin = juce::jmin(k, size - k);
+        auto magnitude = getChainMagnitude(kernelCoefficients, bin * firSampleRate / size, firSampleRate);
+        firSpectrum[(size_t)k] = { (float)magnitude, 0.f };
+    }
+    firFFT->perform(firSpectrum.data(), firImpulse.data(), true);
+
+    auto centre = firKernelSize / 2;
+    juce::AudioBuffer<float> kernel(1, firKernelSize);
+    auto* kernelData = kernel.getWritePointer(0);
+    for (int n = 0; n < firKernelSize; ++n) {
+        kernelData[n] = firImpulse[(size_t)((n - centre + size) % size)].real() * firWindow[(size_t)n];
+    }
+
+    using Convolution = juce::dsp::Convolution;
+    for (auto& convolution : convolutions) {
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel), firSampleRate, Convolution::Stereo::no, Convolution::Trim::no, Convolution::Normalise::no);
+    }
+    return true;
+}
+
+void SimpleEqAudioProcessor::countDesigns(const BandDesignCounts& counts) {
+    for (size_t band = 0; band < redesignCounts.size(); ++band) {
+        redesignCounts[band] += counts.designs[band];
+        cacheHitCounts[band] += counts.cacheHits[band];
+    }
+}
+
+void SimpleEqAudioProcessor::parameterValueChanged(int parameterIndex, float newValue) {
+    ++settingsVersion;
+    coefficientDesignThread->requestDesign();
+    if (parameterIndex == oversamplingParameterIndex || parameterIndex == oversamplingFilterParameterIndex || parameterIndex == phaseModeParameterIndex) {
+        triggerAsyncUpdate();
+    }
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEqAudioProcessor::createParameterLayout() {
@@ -304,6 +1183,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEqAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
 
     layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyzer Resolution", "Analyzer Resolution", juce::StringArray{ "2048", "4096", "8192" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyzer Mode", "Analyzer Mode", juce::StringArray{ "Stereo", "Mid/Side" }, 0));
+
+    juce::StringArray smoothingChoices{ "Off", "16 Samples", "32 Samples", "64 Samples" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Smoothing", "Smoothing", smoothingChoices, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling Filter", "Oversampling Filter", juce::StringArray{ "Polyphase IIR", "FIR Equiripple" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "Phase Mode", juce::StringArray{ "Minimum Phase", "Linear Phase", "Linear Phase (Low Latency)" }, 0));
 
     return layout;
 }
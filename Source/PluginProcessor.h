@@ -12,7 +12,8 @@
 
 #include <array>
 
-template<typename T>
+// Capacity counts slots; one of them always stays free, so Capacity - 1 entries can be queued.
+template<typename T, int Capacity = 30>
 struct Fifo {
     void prepare(int numChannels, int numSamples) {
         static_assert(std::is_same_v < T, juce::AudioBuffer<float>>,
@@ -50,17 +51,82 @@ struct Fifo {
         return false;
     }
 
+    // Swap-based exchange for slots holding heap storage (vectors, paths). `t` must be sized like the
+    // slots; it hands its storage to the FIFO and gets the slot's previous storage back, so a steady
+    // stream of pushes and pulls never allocates.
+    bool pushBySwap(T& t) {
+        auto write = fifo.write(1);
+        if (write.blockSize1 > 0) {
+            std::swap(buffers[write.startIndex1], t);
+            return true;
+        }
+        return false;
+    }
+
+    bool pullBySwap(T& t) {
+        auto read = fifo.read(1);
+        if (read.blockSize1 > 0) {
+            std::swap(t, buffers[read.startIndex1]);
+            return true;
+        }
+        return false;
+    }
+
+    // In-place writing for producers that fill a slot over several calls: beginWrite() returns the
+    // next free slot (or nullptr when the reader has fallen behind) and finishWrite() publishes it.
+    T* beginWrite() {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        return size1 > 0 ? &buffers[(size_t)start1] : nullptr;
+    }
+
+    void finishWrite() {
+        fifo.finishedWrite(1);
+    }
+
+    // Drops up to numToDiscard of the oldest entries without copying them out.
+    void discard(int numToDiscard) {
+        fifo.finishedRead(juce::jlimit(0, fifo.getNumReady(), numToDiscard));
+    }
+
     int getNumAvailableForReading() const {
         return fifo.getNumReady();
     }
 
 private:
-    static constexpr int Capacity = 30;
     std::array<T, Capacity> buffers;
     juce::AbstractFifo fifo{ Capacity };
 
 };
 
+// Wait-free single-producer/single-consumer handoff of the most recently published value.
+// The writer fills getWriteBuffer() and calls publish(); the reader calls pull(), which returns
+// the newest value exactly once and nullptr otherwise. All three slots are preallocated, so
+// neither side ever allocates or frees.
+template<typename T>
+struct LatestValueSlot {
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        writeIndex = middle.exchange(writeIndex | dirtyFlag) & indexMask;
+    }
+
+    const T* pull() {
+        if ((middle.load() & dirtyFlag) == 0) {
+            return nullptr;
+        }
+        readIndex = middle.exchange(readIndex) & indexMask;
+        return &buffers[readIndex];
+    }
+
+private:
+    static constexpr int dirtyFlag = 4;
+    static constexpr int indexMask = 3;
+    std::array<T, 3> buffers;
+    int writeIndex = 0, readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
 enum Channel {
     Right,
     Left
@@ -73,13 +139,40 @@ struct SingleChannelSampleFifo {
         prepared.set(false);
     }
 
+    // Copies the channel straight into the FIFO's preallocated slots in chunks. Slots keep the size
+    // given to prepare(), so this never reallocates, whatever block size the host sends.
     void update(const BlockType& buffer) {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        if (buffer.getNumChannels() == 0) {
+            return;
+        }
+        // A mono layout has no second channel; both FIFOs then carry the only one there is.
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
+        auto numSamples = buffer.getNumSamples();
+        auto slotSize = bufferToFill.getNumSamples();
+
+        for (int i = 0; i < numSamples;) {
+            if (slotToFill == nullptr) {
+                slotToFill = audioBufferFifo.beginWrite();
+
+                // The reader has fallen behind, so this slot's worth of samples gets dropped.
+                if (slotToFill == nullptr) {
+                    slotToFill = &bufferToFill;
+                }
+            }
+
+            auto numToCopy = juce::jmin(numSamples - i, slotSize - fifoIndex);
+            juce::FloatVectorOperations::copy(slotToFill->getWritePointer(0, fifoIndex), channelPtr + i, numToCopy);
+            fifoIndex += numToCopy;
+            i += numToCopy;
 
-        for (int i = 0; i < buffer.getNumSamples(); ++i) {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            if (fifoIndex == slotSize) {
+                if (slotToFill != &bufferToFill) {
+                    audioBufferFifo.finishWrite();
+                }
+                slotToFill = nullptr;
+                fifoIndex = 0;
+            }
         }
     }
 
@@ -88,6 +181,7 @@ struct SingleChannelSampleFifo {
         size.set(bufferSize);
         bufferToFill.setSize(1, bufferSize, false, true, true);
         audioBufferFifo.prepare(1, bufferSize);
+        slotToFill = nullptr;
         fifoIndex = 0;
         prepared.set(true);
     }
@@ -96,25 +190,17 @@ struct SingleChannelSampleFifo {
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
     bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+    void discardAudioBuffers(int numToDiscard) { audioBufferFifo.discard(numToDiscard); }
 
 
 private:
     Channel channelToUse;
     int fifoIndex = 0;
     Fifo<BlockType> audioBufferFifo;
+    BlockType* slotToFill = nullptr;
     BlockType bufferToFill;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-
-    void pushNextSampleIntoFifo(float sample) {
-        if (fifoIndex == bufferToFill.getNumSamples()) {
-            auto ok = audioBufferFifo.push(bufferToFill);
-            juce::ignoreUnused(ok);
-            fifoIndex = 0;
-        }
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
 };
 
 enum Slope {
@@ -133,12 +219,166 @@ struct ChainSettings {
 };
 
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+inline bool lowCutDesignChanged(const ChainSettings& a, const ChainSettings& b) {
+    return a.lowCutFreq != b.lowCutFreq || a.lowCutSlope != b.lowCutSlope;
+}
+
+inline bool peakDesignChanged(const ChainSettings& a, const ChainSettings& b) {
+    return a.peakFreq != b.peakFreq || a.peakGainInDecibels != b.peakGainInDecibels || a.peakQuality != b.peakQuality;
+}
+
+inline bool highCutDesignChanged(const ChainSettings& a, const ChainSettings& b) {
+    return a.highCutFreq != b.highCutFreq || a.highCutSlope != b.highCutSlope;
+}
+
+// True when every band is either bypassed or parked at its neutral extreme.
+inline bool isChainTransparent(const ChainSettings& chainSettings) {
+    auto lowCutNeutral = chainSettings.lowCutBypassed || chainSettings.lowCutFreq <= 20.f;
+    auto peakNeutral = chainSettings.peakBypassed || chainSettings.peakGainInDecibels == 0.f;
+    auto highCutNeutral = chainSettings.highCutBypassed || chainSettings.highCutFreq >= 20000.f;
+    return lowCutNeutral && peakNeutral && highCutNeutral;
+}
+
 using Filter = juce::dsp::IIR::Filter<float>;
 
 using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
 
 using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
 
+// A cut filter's cascade of 1-4 Butterworth biquads, run as one fused loop. Each slope has its own
+// processing instantiation with a compile-time section count; setCoefficients picks it once per
+// coefficient change, so the sample loop carries no bypass checks and no per-section dispatch.
+// The coefficients live in a Cascade that follower filters can share, so a single update reaches
+// every chain; each filter keeps its own state.
+template<typename SampleType>
+struct FusedCutFilter {
+    static constexpr int maxSections = 4;
+    // Unnormalised { b0, b1, b2, a0, a1, a2 }, as ArrayCoefficients designs them.
+    using Biquad = std::array<float, 6>;
+    using State = std::array<std::array<SampleType, 2>, maxSections>;
+
+    struct Cascade {
+        struct Section {
+            float b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+        };
+        using ProcessFunction = void (*)(const Cascade&, const SampleType*, SampleType*, size_t, State&);
+
+        std::array<Section, maxSections> sections;
+        ProcessFunction processFunction{ &processSections<1> };
+        int numSections{ 1 };
+    };
+
+    FusedCutFilter() : cascade(std::make_shared<Cascade>()) {}
+
+    // Not realtime safe.
+    void shareCascadeWith(const FusedCutFilter& lead) { cascade = lead.cascade; }
+
+    // Uses the first slope + 1 sections. Never allocates.
+    void setCoefficients(const std::array<Biquad, maxSections>& biquads, Slope slope) {
+        auto& c = *cascade;
+        c.numSections = juce::jlimit(1, maxSections, (int)slope + 1);
+        for (int i = 0; i < c.numSections; ++i) {
+            auto& biquad = biquads[(size_t)i];
+            auto a0Inverse = biquad[3] != 0.f ? 1.f / biquad[3] : 1.f;
+            c.sections[(size_t)i] = { biquad[0] * a0Inverse, biquad[1] * a0Inverse, biquad[2] * a0Inverse, biquad[4] * a0Inverse, biquad[5] * a0Inverse };
+        }
+
+        switch (c.numSections) {
+            case 1: c.processFunction = &processSections<1>; break;
+            case 2: c.processFunction = &processSections<2>; break;
+            case 3: c.processFunction = &processSections<3>; break;
+            default: c.processFunction = &processSections<4>; break;
+        }
+    }
+
+    int getNumSections() const { return cascade->numSections; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec) {
+        jassert(spec.numChannels == 1);
+        juce::ignoreUnused(spec);
+        reset();
+    }
+
+    void reset() {
+        for (auto& section : state) {
+            section.fill(SampleType{});
+        }
+    }
+
+    template<typename ProcessContext>
+    void process(const ProcessContext& context) noexcept {
+        auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        jassert(inputBlock.getNumChannels() == 1 && outputBlock.getNumChannels() == 1);
+
+        if (context.isBypassed) {
+            if (context.usesSeparateInputAndOutputBlocks()) {
+                outputBlock.copyFrom(inputBlock);
+            }
+            return;
+        }
+
+        // Sections that were idle kept whatever state they had, so a slope increase starts them clean.
+        auto& c = *cascade;
+        if (c.numSections > sectionsInUse) {
+            for (auto i = sectionsInUse; i < c.numSections; ++i) {
+                state[(size_t)i].fill(SampleType{});
+            }
+        }
+        sectionsInUse = c.numSections;
+
+        c.processFunction(c, inputBlock.getChannelPointer(0), outputBlock.getChannelPointer(0), outputBlock.getNumSamples(), state);
+    }
+
+private:
+    // Transposed direct form II, like IIR::Filter.
+    template<int NumSections>
+    static void processSections(const Cascade& c, const SampleType* input, SampleType* output, size_t numSamples, State& state) {
+        std::array<typename Cascade::Section, NumSections> sections;
+        std::array<std::array<SampleType, 2>, NumSections> s;
+        for (int i = 0; i < NumSections; ++i) {
+            sections[(size_t)i] = c.sections[(size_t)i];
+            s[(size_t)i] = state[(size_t)i];
+        }
+
+        for (size_t n = 0; n < numSamples; ++n) {
+            auto x = input[n];
+            for (int i = 0; i < NumSections; ++i) {
+                auto& section = sections[(size_t)i];
+                auto& z = s[(size_t)i];
+                auto y = x * section.b0 + z[0];
+                z[0] = x * section.b1 - y * section.a1 + z[1];
+                z[1] = x * section.b2 - y * section.a2;
+                x = y;
+            }
+            output[n] = x;
+        }
+
+        for (int i = 0; i < NumSections; ++i) {
+            state[(size_t)i] = s[(size_t)i];
+        }
+    }
+
+    std::shared_ptr<Cascade> cascade;
+    State state{};
+    int sectionsInUse{ maxSections };
+};
+
+// The same chain running on SIMD registers, one channel per lane, so every channel shares a
+// single set of coefficients and a single pass through the cascade.
+using SIMDSample = juce::dsp::SIMDRegister<float>;
+using SIMDFilter = juce::dsp::IIR::Filter<SIMDSample>;
+using SIMDCutFilter = FusedCutFilter<SIMDSample>;
+using SIMDChain = juce::dsp::ProcessorChain<SIMDCutFilter, SIMDFilter, SIMDCutFilter>;
+
+// Copy up to SIMDSample::size() channels of `buffer`, starting at startSample, into the lanes of
+// `interleaved` (and back). Lanes without a channel are zeroed.
+void interleaveChannels(const juce::AudioBuffer<float>& buffer, int firstChannel, int numChannels, int startSample, juce::dsp::AudioBlock<SIMDSample>& interleaved);
+// Points follower's filters at lead's coefficients.
+void shareCoefficients(const SIMDChain& lead, SIMDChain& follower);
+void deinterleaveChannels(const juce::dsp::AudioBlock<SIMDSample>& interleaved, juce::AudioBuffer<float>& buffer, int firstChannel, int numChannels, int startSample);
+
 
 
 enum ChainPositions {
@@ -147,8 +387,162 @@ enum ChainPositions {
     HighCut
 };
 
+// A complete, fixed-size coefficient set for one MonoChain. Each band carries a version that is
+// bumped whenever that band is redesigned, so a consumer can tell which bands need applying.
+struct ChainCoefficients {
+    using Biquad = std::array<float, 6>;
+    static constexpr Biquad passThrough{ 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+
+    ChainCoefficients() {
+        lowCut.fill(passThrough);
+        highCut.fill(passThrough);
+    }
+
+    ChainSettings settings;
+    double sampleRate{ 0 };
+    std::array<Biquad, 4> lowCut, highCut;
+    Biquad peak{ passThrough };
+    juce::uint32 lowCutVersion{ 0 }, peakVersion{ 0 }, highCutVersion{ 0 };
+};
+
+//==============================================================================
+// Process-wide store of designed bands, shared by every processor instance so that identical
+// settings (the default low cut on hundreds of tracks, or tracks automated together) are designed
+// once. Lookups are lock-free: each entry is a seqlock whose sequence is odd while a writer fills it,
+// and readers retry nothing, treating a torn read as a miss. Entries carry the clock tick of their
+// last use; when a band's probe window is full, the least recently used entry in it is replaced.
+struct CoefficientDesignCache {
+    enum class Band : juce::uint8 { lowCut, highCut, peak };
+    using Stages = std::array<ChainCoefficients::Biquad, 4>;
+
+    struct Key {
+        Band band;
+        int slope;
+        float freq, gainInDecibels, quality;
+        double sampleRate;
+
+        bool operator==(const Key& other) const {
+            return band == other.band && slope == other.slope && freq == other.freq
+                && gainInDecibels == other.gainInDecibels && quality == other.quality && sampleRate == other.sampleRate;
+        }
+    };
+
+    static Key makeLowCutKey(const ChainSettings& s, double sampleRate) { return { Band::lowCut, s.lowCutSlope, s.lowCutFreq, 0.f, 0.f, sampleRate }; }
+    static Key makeHighCutKey(const ChainSettings& s, double sampleRate) { return { Band::highCut, s.highCutSlope, s.highCutFreq, 0.f, 0.f, sampleRate }; }
+    static Key makePeakKey(const ChainSettings& s, double sampleRate) { return { Band::peak, 0, s.peakFreq, s.peakGainInDecibels, s.peakQuality, sampleRate }; }
+
+    // Copies a cached design into `stages`; false on a miss. A peak design lives in stages[0].
+    bool find(const Key& key, Stages& stages) {
+        auto first = hash(key);
+        for (size_t i = 0; i < maxProbes; ++i) {
+            auto& entry = entries[(first + i) & slotMask];
+            auto sequence = entry.sequence.load(std::memory_order_acquire);
+            // Slots never empty again once filled, so an empty one ends the probe sequence.
+            if (sequence == 0) {
+                return false;
+            }
+            if ((sequence & 1) != 0 || !(entry.key == key)) {
+                continue;
+            }
+            auto copy = entry.stages;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) != sequence) {
+                return false;
+            }
+            stages = copy;
+            entry.lastUsed.store(clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void insert(const Key& key, const Stages& stages) {
+        auto first = hash(key);
+        Entry* victim = nullptr;
+        auto victimSequence = 0u;
+        for (size_t i = 0; i < maxProbes; ++i) {
+            auto& entry = entries[(first + i) & slotMask];
+            auto sequence = entry.sequence.load(std::memory_order_acquire);
+            if (sequence == 0) {
+                victim = &entry;
+                victimSequence = 0;
+                break;
+            }
+            if ((sequence & 1) != 0) {
+                continue;
+            }
+            if (entry.key == key) {
+                return;
+            }
+            if (victim == nullptr || entry.lastUsed.load(std::memory_order_relaxed) < victim->lastUsed.load(std::memory_order_relaxed)) {
+                victim = &entry;
+                victimSequence = sequence;
+            }
+        }
+
+        // Every slot of the window is being written; this design just goes uncached.
+        if (victim == nullptr || !victim->sequence.compare_exchange_strong(victimSequence, victimSequence + 1, std::memory_order_acquire)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        victim->key = key;
+        victim->stages = stages;
+        victim->lastUsed.store(clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        victim->sequence.store(victimSequence + 2, std::memory_order_release);
+        if (victimSequence == 0) {
+            numEntries.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            numEvictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    int getNumEntries() const { return numEntries.load(); }
+    int getNumEvictions() const { return numEvictions.load(); }
+
+private:
+    static constexpr size_t numSlots = 4096, slotMask = numSlots - 1, maxProbes = 16;
+
+    struct Entry {
+        // 0 while empty, odd while being written.
+        std::atomic<juce::uint32> sequence{ 0 };
+        std::atomic<juce::uint32> lastUsed{ 0 };
+        Key key{};
+        Stages stages{};
+    };
+
+    // Parameters move in steps of 1 Hz, 0.5 dB and 0.05, so hashing them on those grids spreads
+    // neighbouring settings over the table; matching still compares the exact values.
+    static size_t hash(const Key& key) {
+        auto h = (juce::uint64)key.band * 0x9e3779b97f4a7c15ull;
+        auto mix = [&h](juce::int64 value) { h = (h ^ (juce::uint64)value) * 0x100000001b3ull; };
+        mix(key.slope);
+        mix(juce::roundToInt(key.freq));
+        mix(juce::roundToInt(key.gainInDecibels * 2.f));
+        mix(juce::roundToInt(key.quality * 20.f));
+        mix(juce::roundToInt(key.sampleRate));
+        return (size_t)(h ^ (h >> 29));
+    }
+
+    std::array<Entry, numSlots> entries;
+    std::atomic<juce::uint32> clock{ 1 };
+    std::atomic<int> numEntries{ 0 }, numEvictions{ 0 };
+};
+
+// What designChainCoefficients did for each band, indexed by ChainPositions.
+struct BandDesignCounts {
+    std::array<int, 3> designs{}, cacheHits{};
+};
+
+// Redesigns the bands of `coefficients` whose inputs differ from `chainSettings` (or all of them
+// when forceFullDesign is set), taking designs from `cache` when one is given and tallying into
+// `counts` when one is given. Never allocates, so it is safe to call from any thread.
+void designChainCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& coefficients, bool forceFullDesign,
+                             CoefficientDesignCache* cache = nullptr, BandDesignCounts* counts = nullptr);
+
 using Coefficients = Filter::CoefficientsPtr;
 void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+void updateCoefficients(Coefficients& old, const ChainCoefficients::Biquad& replacements);
 
 Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
 
@@ -190,10 +584,367 @@ inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleR
     return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
 }
 
+//==============================================================================
+// Audio-thread diagnostics. When SIMPLEEQ_AUDIO_THREAD_GUARD is on (debug builds by default) the
+// plugin replaces the global allocation functions (see PluginProcessor.cpp for what that reaches
+// on each platform), and every allocation they see while a Scope is alive on the current thread
+// is counted; the first one also trips an assertion.
+// Every lock the processor shares between threads is a GuardedCriticalSection, so one taken from
+// processBlock is caught the same way. Bounded spin-waits the audio thread does by design (joining
+// the worker pool) are only counted. The host's callback lock, which suspendProcessing() contends
+// for, is taken around processBlock rather than inside it, so it is out of the guard's reach.
+#ifndef SIMPLEEQ_AUDIO_THREAD_GUARD
+ #if JUCE_DEBUG
+  #define SIMPLEEQ_AUDIO_THREAD_GUARD 1
+ #else
+  #define SIMPLEEQ_AUDIO_THREAD_GUARD 0
+ #endif
+#endif
+
+struct AudioThreadGuard {
+    // Marks the current thread as being inside processBlock for its lifetime.
+    struct Scope {
+        Scope() { ++depth; }
+        ~Scope() { --depth; }
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    static bool isActive() { return depth > 0; }
+    static constexpr bool isEnabled() { return SIMPLEEQ_AUDIO_THREAD_GUARD != 0; }
+
+    static void noteAllocation() { note(allocations); }
+    static void noteLock() { note(locks); }
+    static void noteWait() {
+        if (isActive()) {
+            ++waits;
+        }
+    }
+
+    static int getAllocationCount() { return allocations.load(); }
+    static int getLockCount() { return locks.load(); }
+    static int getWaitCount() { return waits.load(); }
+
+private:
+    static void note(std::atomic<int>& counter) {
+        if (!isActive()) {
+            return;
+        }
+        ++counter;
+        // Asserting may itself allocate, so leave the scope while it runs and only do it once.
+        if (!reported.exchange(true)) {
+            --depth;
+            jassertfalse;
+            ++depth;
+        }
+    }
+
+    static inline thread_local int depth = 0;
+    static inline std::atomic<int> allocations{ 0 }, locks{ 0 }, waits{ 0 };
+    static inline std::atomic<bool> reported{ false };
+};
+
+// A CriticalSection that reports every blocking entry to AudioThreadGuard. Lock it through its
+// own ScopedLockType; juce::ScopedLock only takes a plain CriticalSection.
+class GuardedCriticalSection {
+public:
+    void enter() const noexcept {
+        AudioThreadGuard::noteLock();
+        lock.enter();
+    }
+    bool tryEnter() const noexcept { return lock.tryEnter(); }
+    void exit() const noexcept { lock.exit(); }
+
+    using ScopedLockType = juce::GenericScopedLock<GuardedCriticalSection>;
+
+private:
+    juce::CriticalSection lock;
+};
+
+// Lock-free histogram of processBlock's duration as a fraction of the block's realtime budget
+// (its length in seconds at the host rate). Written by the audio thread, read from anywhere.
+struct ProcessTimingHistogram {
+    // Upper edges of every bucket but the last, as a fraction of the budget.
+    static constexpr std::array<float, 12> bucketLimits{ 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.f, 1.5f, 2.f };
+    static constexpr size_t numBuckets = bucketLimits.size() + 1;
+
+    struct Snapshot {
+        std::array<juce::uint32, numBuckets> counts{};
+        juce::uint32 numBlocks{ 0 }, numOverruns{ 0 };
+        float maxLoad{ 0 };
+    };
+
+    void record(double secondsTaken, double budgetSeconds) {
+        if (budgetSeconds <= 0) {
+            return;
+        }
+        auto load = (float)(secondsTaken / budgetSeconds);
+
+        size_t bucket = 0;
+        while (bucket < bucketLimits.size() && load >= bucketLimits[bucket]) {
+            ++bucket;
+        }
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        numBlocks.fetch_add(1, std::memory_order_relaxed);
+        if (load > 1.f) {
+            numOverruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto previousMax = maxLoad.load(std::memory_order_relaxed);
+        while (load > previousMax && !maxLoad.compare_exchange_weak(previousMax, load, std::memory_order_relaxed)) {}
+    }
+
+    Snapshot getSnapshot() const {
+        Snapshot snapshot;
+        for (size_t i = 0; i < numBuckets; ++i) {
+            snapshot.counts[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+        snapshot.numOverruns = numOverruns.load(std::memory_order_relaxed);
+        snapshot.maxLoad = maxLoad.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // Counts recorded concurrently with a reset may survive it.
+    void reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        numBlocks.store(0, std::memory_order_relaxed);
+        numOverruns.store(0, std::memory_order_relaxed);
+        maxLoad.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<juce::uint32>, numBuckets> buckets{};
+    std::atomic<juce::uint32> numBlocks{ 0 }, numOverruns{ 0 };
+    std::atomic<float> maxLoad{ 0 };
+};
+
+//==============================================================================
+// Counting semaphore built on the platform's own, so that post() is a single non-blocking kernel
+// call that never takes a user-space lock or allocates. That makes it safe for the audio thread
+// to wake sleeping threads with it.
+struct WorkerSemaphore {
+    WorkerSemaphore();
+    ~WorkerSemaphore();
+
+    void post(int count);
+    void wait();
+
+private:
+    void* handle{ nullptr };
+    JUCE_DECLARE_NON_COPYABLE(WorkerSemaphore)
+};
+
+//==============================================================================
+// Process-wide worker that designs coefficient sets for every registered processor, so Butterworth
+// design never runs on the audio thread. It sleeps until requestDesign() is called, which only
+// posts a semaphore (and only once per pending pass), so parameter changes arriving on the audio
+// thread can wake it without taking a lock. Each pass lets every client catch up.
+struct CoefficientDesignThread : juce::Thread {
+    struct Client {
+        virtual ~Client() = default;
+        virtual void designCoefficients() = 0;
+    };
+
+    CoefficientDesignThread() : juce::Thread("SimpleEq Coefficient Designer") {
+        startThread();
+    }
+
+    ~CoefficientDesignThread() override {
+        signalThreadShouldExit();
+        wakeUp.post(1);
+        stopThread(1000);
+    }
+
+    void requestDesign() {
+        if (!designPending.exchange(true)) {
+            wakeUp.post(1);
+        }
+    }
+
+    void addClient(Client* client) {
+        const GuardedCriticalSection::ScopedLockType sl(clientLock);
+        clients.addIfNotAlreadyThere(client);
+    }
+
+    void removeClient(Client* client) {
+        const GuardedCriticalSection::ScopedLockType sl(clientLock);
+        clients.removeFirstMatchingValue(client);
+    }
+
+    void run() override {
+        for (;;) {
+            wakeUp.wait();
+            if (threadShouldExit()) {
+                return;
+            }
+            // Cleared before the pass, so a change made during it asks for another one.
+            designPending = false;
+            const GuardedCriticalSection::ScopedLockType sl(clientLock);
+            for (auto* client : clients) {
+                client->designCoefficients();
+            }
+        }
+    }
+
+private:
+    WorkerSemaphore wakeUp;
+    std::atomic<bool> designPending{ false };
+    GuardedCriticalSection clientLock;
+    juce::Array<Client*> clients;
+};
+
+//==============================================================================
+// Process-wide worker threads that help audio threads through a batch of independent jobs; share
+// it with a SharedResourcePointer. run() never allocates or locks: the batch is published through
+// one atomic word holding a generation, the job count and the next unclaimed job, the workers are
+// woken through the semaphore, and the caller claims jobs too before spin-waiting for the rest.
+// Because the caller can finish a batch alone, a worker that wakes late only costs parallelism,
+// never a deadline. Between batches the workers sleep on the semaphore, so an idle pool costs no CPU.
+struct RealtimeWorkerPool {
+    using JobFunction = void (*)(void* context, int jobIndex);
+
+    ~RealtimeWorkerPool() {
+        stop();
+    }
+
+    // Makes sure at least numWorkers workers are running. Not realtime safe; call from
+    // prepareToPlay or the message thread.
+    void start(int numWorkers) {
+        const GuardedCriticalSection::ScopedLockType sl(workersLock);
+        while ((int)workers.size() < numWorkers) {
+            workers.push_back(std::make_unique<Worker>(*this));
+            auto& worker = *workers.back();
+            if (!worker.startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(9))) {
+                worker.startThread(juce::Thread::Priority::highest);
+            }
+        }
+        numRunningWorkers = (int)workers.size();
+    }
+
+    int getNumWorkers() const { return numRunningWorkers.load(); }
+
+    // Calls jobFunction(context, i) for every i below numJobs, spread over the workers and the calling
+    // thread, and returns true once all of them have finished. While another thread's batch is in
+    // flight it returns false straight away, without running anything.
+    bool run(int numJobs, JobFunction jobFunction, void* context) {
+        jassert(juce::isPositiveAndBelow(numJobs, (int)jobMask));
+        if (busy.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+
+        currentJobFunction = jobFunction;
+        currentJobContext = context;
+        jobsRemaining.store(numJobs, std::memory_order_relaxed);
+
+        auto generation = (batch.load(std::memory_order_relaxed) >> 32) + 1;
+        batch.store((generation << 32) | ((juce::uint64)numJobs << 16), std::memory_order_release);
+        semaphore.post(juce::jmin(numJobs - 1, numRunningWorkers.load()));
+
+        while (runNextJob()) {}
+        if (jobsRemaining.load(std::memory_order_acquire) > 0) {
+            AudioThreadGuard::noteWait();
+            while (jobsRemaining.load(std::memory_order_acquire) > 0) {}
+        }
+
+        busy.store(false, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr juce::uint64 jobMask = 0xffff;
+
+    struct Worker : juce::Thread {
+        explicit Worker(RealtimeWorkerPool& p) : juce::Thread("SimpleEq Channel Worker"), pool(p) {}
+
+        void run() override {
+            while (!threadShouldExit()) {
+                pool.semaphore.wait();
+                while (pool.runNextJob()) {}
+            }
+        }
+
+        RealtimeWorkerPool& pool;
+    };
+
+    void stop() {
+        const GuardedCriticalSection::ScopedLockType sl(workersLock);
+        numRunningWorkers = 0;
+        for (auto& worker : workers) {
+            worker->signalThreadShouldExit();
+        }
+        semaphore.post((int)workers.size());
+        for (auto& worker : workers) {
+            worker->stopThread(1000);
+        }
+        workers.clear();
+    }
+
+    // Claims the next job of the current batch and runs it; false when nothing is left to claim.
+    bool runNextJob() {
+        auto current = batch.load(std::memory_order_acquire);
+        for (;;) {
+            auto numJobs = (current >> 16) & jobMask;
+            auto nextJob = current & jobMask;
+            if (nextJob >= numJobs) {
+                return false;
+            }
+            if (batch.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                // The batch can't be replaced until this job is counted off, so these are still ours.
+                currentJobFunction(currentJobContext, (int)nextJob);
+                jobsRemaining.fetch_sub(1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    // generation << 32 | job count << 16 | next unclaimed job
+    std::atomic<juce::uint64> batch{ 0 };
+    std::atomic<int> jobsRemaining{ 0 };
+    std::atomic<bool> busy{ false };
+    JobFunction currentJobFunction{ nullptr };
+    void* currentJobContext{ nullptr };
+    WorkerSemaphore semaphore;
+
+    GuardedCriticalSection workersLock;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> numRunningWorkers{ 0 };
+};
+
+//==============================================================================
+// Preferences that change nothing audible, kept as properties of apvts.state rather than as
+// parameters so that hosts neither list nor automate them. They are saved with the session like
+// the parameters; a property that is missing reads as its default. Message thread only.
+namespace StateProperties {
+// Analyzer hop: choice index 0 (latest frame only) to 3 (8x overlap).
+inline const juce::Identifier analyzerOverlap{ "AnalyzerOverlap" };
+constexpr int analyzerOverlapDefault = 0;
+
+// Analyzer redraw cap: choice index 0 (15 fps) to 3 (120 fps).
+inline const juce::Identifier analyzerFrameRate{ "AnalyzerFrameRate" };
+constexpr int analyzerFrameRateDefault = 2;
+inline const std::array<int, 4> analyzerFrameRates{ 15, 30, 60, 120 };
+
+// Whether the editor renders the response curve through OpenGL.
+inline const juce::Identifier openGLRendering{ "OpenGLRendering" };
+constexpr bool openGLRenderingDefault = false;
+
+// Channels x samples per block from which processBlock spreads channel groups over the worker
+// pool: choice index 0 (off) to 3 (131072). Changes the work split, never the output.
+inline const juce::Identifier parallelProcessing{ "ParallelProcessing" };
+constexpr int parallelProcessingDefault = 0;
+inline const std::array<int, 4> parallelProcessingThresholds{ 0, 8192, 32768, 131072 };
+
+// Every property above; state loading copies exactly these.
+inline const std::array<juce::Identifier, 4> all{ analyzerOverlap, analyzerFrameRate, openGLRendering, parallelProcessing };
+}
+
 //==============================================================================
 /**
 */
-class SimpleEqAudioProcessor : public juce::AudioProcessor
+class SimpleEqAudioProcessor : public juce::AudioProcessor, juce::AudioProcessorParameter::Listener, CoefficientDesignThread::Client, juce::AsyncUpdater,
+                               juce::ValueTree::Listener
 #if JucePlugin_Enable_ARA
     , public juce::AudioProcessorARAExtension
 #endif
@@ -210,6 +961,7 @@ public:
 #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 #endif
+    static constexpr int maxSupportedChannels = 16;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
@@ -244,14 +996,191 @@ public:
     SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
     SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
 
+    // Analyzer consumers (editors with the analyzer showing) register here. While none is attached,
+    // processBlock skips the FIFO tap altogether.
+    void addAnalyzerConsumer() { ++analyzerConsumers; }
+    void removeAnalyzerConsumer() { --analyzerConsumers; }
+
+    // Number of times each band's coefficients have been designed since construction, and the
+    // number of times a band was taken from the shared design cache instead.
+    int getRedesignCount(ChainPositions band) const { return redesignCounts[band].load(); }
+    int getCacheHitCount(ChainPositions band) const { return cacheHitCounts[band].load(); }
+
+    // The rate the filters run at, which oversampling raises above the host rate; 0 until prepared.
+    double getChainSampleRate() const { return designSampleRate.load(); }
+
+    // processBlock's duration against each block's realtime budget.
+    ProcessTimingHistogram::Snapshot getProcessTimingSnapshot() const { return processTiming.getSnapshot(); }
+    void resetProcessTiming() { processTiming.reset(); }
+
 private:
-    MonoChain leftChain, rightChain;
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    // `chain` processes the first SIMDSample::size() channels, and the pool holds one more chain per
+    // further group of that many channels. Pooled chains share `chain`'s coefficient objects, so
+    // every update reaches all channels at once; only filter state and bypass flags are per chain.
+    SIMDChain chain;
+    std::vector<std::unique_ptr<SIMDChain>> chainPool;
+    void syncChainPoolBypassStates();
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDSample> interleaved;
+    void processChain(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void processChannelGroup(int group, juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void processFilters(juce::AudioBuffer<float>& buffer, int subBlockSize);
+
+    // False when the data isn't an intact binary state block, e.g. state from older versions.
+    bool setBinaryStateInformation(const void* data, int sizeInBytes);
+    // Takes every StateProperties entry from `saved`, dropping those it doesn't have.
+    void restoreStateProperties(const juce::ValueTree& saved);
+
+    // Oversampling mode: the chain runs at 2^oversamplingOrder times the host rate, so the cut and
+    // peak designs don't cramp near Nyquist. The oversampler only exists while the mode is on; a
+    // change of mode re-prepares the processor from the message thread.
+    std::atomic<float>* oversamplingParameter{ nullptr };
+    std::atomic<float>* oversamplingFilterParameter{ nullptr };
+    int oversamplingParameterIndex{ -1 }, oversamplingFilterParameterIndex{ -1 };
+    int oversamplingOrder{ 0 }, oversamplingFilterType{ 0 };
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    // The oversampler's latency in host-rate samples, for getTailLengthSeconds on any thread.
+    std::atomic<int> oversamplerTailSamples{ 0 };
+    int oversampledNumChannels{ 0 }, oversamplingBlockSize{ 0 };
+    std::array<float*, maxSupportedChannels> oversampledChannels{};
+    void processOversampled(juce::AudioBuffer<float>& buffer, int subBlockSize);
+    void handleAsyncUpdate() override;
+    // Everything prepareToPlay sets up except the analyzer FIFOs, which no mode change affects.
+    void prepareProcessing(double sampleRate, int samplesPerBlock);
+
+    // Linear phase modes: the chain's combined magnitude response becomes a zero-phase FIR kernel,
+    // built on the kernel thread and run through one partitioned convolution per channel pair.
+    // Convolution crossfades to each new kernel. The modes differ only in the partitioning: uniform
+    // partitions add their size to the latency, the low latency scheme has a zero-latency head.
+    enum PhaseMode { minimumPhase, linearPhase, linearPhaseLowLatency };
+    static constexpr int uniformPartitionSize = 1024, lowLatencyHeadSize = 256;
+    std::atomic<float>* phaseModeParameter{ nullptr };
+    int phaseModeParameterIndex{ -1 };
+    int phaseMode{ minimumPhase };
+    void prepareLinearPhase(double sampleRate, int samplesPerBlock);
+    void releaseLinearPhase();
+    void processLinearPhase(juce::AudioBuffer<float>& buffer);
+
+    // Shared by prepareToPlay and the kernel thread; the audio thread only runs the convolutions.
+    GuardedCriticalSection linearPhaseLock;
+    // One loader thread for all of this processor's convolutions; it must outlive them.
+    std::unique_ptr<juce::dsp::ConvolutionMessageQueue> convolutionQueue;
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    int firFFTSize{ 0 }, firKernelSize{ 0 };
+    double firSampleRate{ 0 };
+
+    // Kernels are built on a thread of this processor's own, so that a rebuild never holds up the
+    // shared design thread. The design thread publishes a chain only when a band design or bypass
+    // changed, and the kernel thread rebuilds at most once per minimumRebuildIntervalMs.
+    struct KernelDesignThread : juce::Thread {
+        explicit KernelDesignThread(SimpleEqAudioProcessor& p) : juce::Thread("SimpleEq FIR Designer"), processor(p) {}
+        void run() override;
+        SimpleEqAudioProcessor& processor;
+    };
+    static constexpr int minimumRebuildIntervalMs = 50;
+    LatestValueSlot<ChainCoefficients> kernelCoefficientSlot;
+    std::atomic<bool> kernelNeedsRebuild{ false };
+    // Owned by the kernel thread once prepared.
+    ChainCoefficients kernelCoefficients;
+    std::unique_ptr<juce::dsp::FFT> firFFT;
+    std::vector<juce::dsp::Complex<float>> firSpectrum, firImpulse;
+    std::vector<float> firWindow;
+    // False when there was nothing new to build.
+    bool rebuildLinearPhaseKernel();
+    KernelDesignThread kernelDesignThread{ *this };
+
+    // Parallel processing (opt-in through the ParallelProcessing state property): blocks of wide buses
+    // with at least the chosen number of channels x samples spread their channel groups over the
+    // shared worker pool, so small buffers stay on the audio thread alone. Each pooled chain gets
+    // its own interleave scratch so that groups can run concurrently.
+    std::vector<juce::HeapBlock<char>> pooledInterleavedData;
+    std::vector<juce::dsp::AudioBlock<SIMDSample>> pooledInterleaved;
+    // Copied from the state property, which the audio thread can't read; 0 while parallel
+    // processing is off.
+    std::atomic<int> parallelThreshold{ 0 };
+    int getParallelThreshold() const { return parallelThreshold.load(); }
+    void updateParallelThreshold();
+    void startWorkerPoolIfNeeded();
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+    void valueTreeRedirected(juce::ValueTree&) override { updateParallelThreshold(); }
+    juce::SharedResourcePointer<RealtimeWorkerPool> workerPool;
+
+    // When the chain is transparent processBlock skips it entirely, fading between the dry and
+    // filtered signal on the way in and out.
+    static constexpr double transparencyFadeSeconds = 0.02;
+    bool chainIsTransparent{ false }, chainNeedsReset{ false };
+    juce::SmoothedValue<float> wetLevel;
+    juce::AudioBuffer<float> dryBuffer;
+    void applyCrossfade(juce::AudioBuffer<float>& buffer);
+
+    std::atomic<int> analyzerConsumers{ 0 };
+    void updateAnalyzerFifos(const juce::AudioBuffer<float>& buffer);
+
+    void updatePeakFilter(const ChainCoefficients& coefficients);
     
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    void updateLowCutFilters(const ChainCoefficients& coefficients);
+    void updateHighCutFilters(const ChainCoefficients& coefficients);
+    void updateBypassStates(const ChainSettings& chainSettings);
+    void applyCoefficients(const ChainCoefficients& coefficients);
     void updateFilters();
 
+    // Smoothing mode: frequencies, gain and Q ramp towards their targets and the chain is
+    // redesigned on the audio thread at the start of every sub-block while a ramp is running.
+    int getSmoothingSubBlockSize() const;
+    void updateSmoothingMode(bool shouldSmooth);
+    void updateSmoothedFilters(int numSamples);
+    void resetSmoothers(const ChainSettings& chainSettings);
+
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {};
+
+    // Called on the design thread.
+    void designCoefficients() override;
+    void countDesigns(const BandDesignCounts& counts);
+
+    double processingSampleRate{ 0 };
+
+    // Bumped by every parameter change so the designer only re-reads the apvts when something moved.
+    std::atomic<juce::uint32> settingsVersion{ 0 };
+    std::atomic<double> designSampleRate{ 0 };
+
+    // Owned by the design thread.
+    juce::uint32 designedSettingsVersion{ 0 };
+    ChainCoefficients designedCoefficients;
+
+    // Owned by the audio thread.
+    LatestValueSlot<ChainCoefficients> coefficientSlot;
+    const ChainCoefficients* latestDesignedCoefficients{ nullptr };
+    juce::uint32 appliedLowCutVersion{ 0 }, appliedPeakVersion{ 0 }, appliedHighCutVersion{ 0 };
+    bool applyAllBands{ true };
+
+    static constexpr double smoothingRampSeconds = 0.05;
+    std::atomic<float>* smoothingParameter{ nullptr };
+    bool smoothingActive{ false }, smoothedSettingsDirty{ false };
+    juce::uint32 smoothedSettingsVersion{ 0 };
+    ChainSettings smoothingTarget;
+    ChainCoefficients smoothedCoefficients;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreqSmoother, highCutFreqSmoother, peakFreqSmoother;
+    juce::SmoothedValue<float> peakGainSmoother, peakQualitySmoother;
+
+    std::array<std::atomic<int>, 3> redesignCounts{}, cacheHitCounts{};
+    ProcessTimingHistogram processTiming;
+    // Records the enclosing processBlock call, whichever way it returns.
+    struct ScopedProcessTimer {
+        ScopedProcessTimer(SimpleEqAudioProcessor& p, int numSamples)
+            : processor(p), budgetSeconds(p.getSampleRate() > 0 ? numSamples / p.getSampleRate() : 0.0) {}
+        ~ScopedProcessTimer() {
+            processor.processTiming.record(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks), budgetSeconds);
+        }
+        SimpleEqAudioProcessor& processor;
+        double budgetSeconds;
+        juce::int64 startTicks{ juce::Time::getHighResolutionTicks() };
+    };
+
+    juce::SharedResourcePointer<CoefficientDesignThread> coefficientDesignThread;
+    // Used for designs from parameter values only; smoothed ramps would fill it with one-off settings.
+    juce::SharedResourcePointer<CoefficientDesignCache> coefficientDesignCache;
+
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEqAudioProcessor)